@@ -382,3 +382,31 @@ int Addsynth::load (const char* sdir)
       f.close();
       return 0;
       }
+
+//---------------------------------------------------------
+//   checksum
+//    hash of all synthesis parameters, used to detect a
+//    changed stop definition in the wave cache
+//---------------------------------------------------------
+
+uint32_t Addsynth::checksum () const
+      {
+      const char* p0 = (const char*) &_n0;
+      const char* p1 = (const char*) (&_h_atp + 1);
+      return aeolus_hash (2166136261u, p0, p1 - p0);
+      }
+
+//---------------------------------------------------------
+//   aeolus_hash
+//    32 bit FNV-1a
+//---------------------------------------------------------
+
+uint32_t aeolus_hash (uint32_t h, const void *data, int n)
+      {
+      const unsigned char* p = (const unsigned char*) data;
+      while (n--) {
+            h ^= *p++;
+            h *= 16777619u;
+            }
+      return h;
+      }
@@ -19,6 +19,7 @@
 
 #include "messages.h"
 #include "aeolus.h"
+#include "libmscore/dsp.h"
 
 //---------------------------------------------------------
 //   start
@@ -198,10 +199,14 @@ void Aeolus::process(unsigned nframes, float* lout, float* rout, float gain)
                   nout = PERIOD;
                   k += PERIOD;
                   }
-            *lout++ += gain * loutb[PERIOD - nout];
-            *rout++ += gain * routb[PERIOD - nout];
-            --nout;
-            --nframes;
+            // copy as much of the current period as fits
+            int n = nout < int(nframes) ? nout : int(nframes);
+            dsp->mixWithGain(lout, loutb + PERIOD - nout, n, gain);
+            dsp->mixWithGain(rout, routb + PERIOD - nout, n, gain);
+            lout    += n;
+            rout    += n;
+            nout    -= n;
+            nframes -= n;
             }
       }
 
@@ -24,20 +24,6 @@ extern float exp2ap (float);
 
 
 Rngen   Pipewave::_rgen;
-float  *Pipewave::_arg = 0;
-float  *Pipewave::_att = 0;
-
-
-void Pipewave::initstatic (float fsamp)
-{
-    int k;
-
-    if (_arg) return;
-    k = (int)(fsamp);
-    _arg = new float [k];
-    k = (int)(0.5f * fsamp);
-    _att = new float [k];
-}
 
 
 void Pipewave::play (void)
@@ -180,10 +166,23 @@ void Pipewave::play (void)
 }
 
 
-void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
+void Pipewave::genjob (Pipejob& J)
+{
+    J._pipe->genwave (J._synth, J._n, J._fsamp, J._fpipe, J._seed);
+}
+
+
+void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe, uint32_t seed)
 {
     int    h, i, k, nc;
     float  f0, f1, f, m, t, v, v0;
+    Rngen  rgen;
+
+    // Private generator and work buffers, so that pipes can be
+    // computed on any thread, with reproducible results.
+    rgen.init (seed);
+    float *arg = new float [(int)(fsamp)];
+    float *att = new float [(int)(0.5f * fsamp)];
 
     m = D->_n_att.vi (n);
     for (h = 0; h < N_HARM; h++)
@@ -194,7 +193,7 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
     _l0 = (int)(fsamp * m + 0.5);
     _l0 = (_l0 + PERIOD - 1) & ~(PERIOD - 1);
 
-    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * _rgen.urand () - 1)) / fsamp;
+    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * rgen.urand () - 1)) / fsamp;
     f0 = f1 * exp2ap (D->_n_atd.vi (n) / 1200.0f);
 
     for (h = N_HARM - 1; h >= 0; h--)
@@ -231,14 +230,14 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
     k = (int)(fsamp * D->_n_att.vi (n) + 0.5);
     for (i = 0; i <= _l0; i++)
     {
-        _arg [i] = t - floorf (t + 0.5);
+        arg [i] = t - floorf (t + 0.5);
 	t += (i < k) ? (((k - i) * f0 + i * f1) / k) : f1;
     }
 
     for (i = 1; i < _l1; i++)
     {
-	t = _arg [_l0]+ (float) i * nc / _l1;
-        _arg [i + _l0] = t - floorf (t + 0.5);
+	t = arg [_l0]+ (float) i * nc / _l1;
+        arg [i + _l0] = t - floorf (t + 0.5);
     }
 
     v0 = exp2ap (0.1661 * D->_n_vol.vi (n));
@@ -248,20 +247,23 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
         v = D->_h_lev.vi (h, n);
         if (v < -80.0) continue;
 
-        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * _rgen.urand () - 1)));
+        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * rgen.urand () - 1)));
         k = (int)(fsamp * D->_h_att.vi (h, n) + 0.5);
-        attgain (k, D->_h_atp.vi (h, n));
+        attgain (att, k, D->_h_atp.vi (h, n));
 
         for (i = 0; i < _l0 + _l1; i++)
         {
-	    t = _arg [i] * (h + 1);
+	    t = arg [i] * (h + 1);
             t -= floorf (t);
             m = v * sinf (2 * M_PI * t);
-            if (i < k) m *= _att [i];
+            if (i < k) m *= att [i];
             _p0 [i] += m;
         }
     }
     for (i = 0; i < _k_s * (PERIOD + 4); i++) _p0 [i + _l0 + _l1] = _p0 [i + _l0];
+
+    delete[] arg;
+    delete[] att;
 }
 
 
@@ -308,7 +310,7 @@ void Pipewave::looplen (float f, float fsamp, int lmax, int *aa, int *bb)
 }
 
 
-void Pipewave::attgain (int n, float p)
+void Pipewave::attgain (float *att, int n, float p)
 {
     int    i, j, k;
     float  d, m, w, x, y, z;
@@ -328,14 +330,14 @@ void Pipewave::attgain (int n, float p)
         while (j < k)
 	{
             m = (double) j / n;
-            _att [j++] = (1.0 - m) * z + m;
+            att [j++] = (1.0 - m) * z + m;
             z += d;
 	}
     }
 }
 
 
-void Pipewave::save (FILE *F)
+uint32_t Pipewave::save (FILE *F, uint32_t h)
 {
     int  k;
     union
@@ -357,10 +359,12 @@ void Pipewave::save (FILE *F)
     fwrite (&d, 1, 32, F);
     k = _l0 +_l1 + _k_s * (PERIOD + 4);
     fwrite (_p0, k, sizeof (float), F);
+    h = aeolus_hash (h, &d, 32);
+    return aeolus_hash (h, _p0, k * sizeof (float));
 }
 
 
-void Pipewave::load (FILE *F)
+uint32_t Pipewave::load (FILE *F, uint32_t h)
 {
     int  k;
     union
@@ -370,18 +374,21 @@ void Pipewave::load (FILE *F)
 	float   flt [8];
     } d;
 
-    fread (&d, 1, 32, F);
+    if (fread (&d, 1, 32, F) != 32) return ~h;
     _l0  = d.i32 [0];
     _l1  = d.i32 [1];
     _k_s = d.i16 [4];
     _k_r = d.i16 [5];
     _m_r = d.flt [3];
     k = _l0 +_l1 + _k_s * (PERIOD + 4);
+    if ((_l0 < 0) || (_l1 <= 0) || (_k_s <= 0) || (k > (1 << 24))) return ~h;
     delete[] _p0;
     _p0 = new float [k];
     _p1 = _p0 + _l0;
     _p2 = _p1 + _l1;
-    fread (_p0, k, sizeof (float), F);
+    if (fread (_p0, sizeof (float), k, F) != (size_t) k) return ~h;
+    h = aeolus_hash (h, &d, 32);
+    return aeolus_hash (h, _p0, k * sizeof (float));
 }
 
 
@@ -401,13 +408,21 @@ Rankwave::~Rankwave (void)
 
 void Rankwave::gen_waves (Addsynth *D, float fsamp, float fbase, float *scale)
 {
-    Pipewave::initstatic (fsamp);
+    QVector<Pipejob> jobs (_n1 - _n0 + 1);
+    uint32_t         csum = D->checksum ();
 
     fbase *=  D->_fn / (D->_fd * scale [9]);
     for (int i = _n0; i <= _n1; i++)
     {
-	_pipes [i - _n0].genwave (D, i - _n0, fsamp, ldexpf (fbase * scale [i % 12], i / 12 - 5));
+        Pipejob& J = jobs [i - _n0];
+        J._pipe  = _pipes + (i - _n0);
+        J._synth = D;
+        J._n     = i - _n0;
+        J._fsamp = fsamp;
+        J._fpipe = ldexpf (fbase * scale [i % 12], i / 12 - 5);
+        J._seed  = (csum ^ (i * 2654435761u)) | 1;
     }
+    QtConcurrent::blockingMap (jobs, Pipewave::genjob);
     _modif = true;
 }
 
@@ -452,6 +467,7 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
     FILE      *F;
     Pipewave  *P;
     int        i;
+    uint32_t   h;
     char       name [1024];
     char       data [64];
     char      *p;
@@ -467,16 +483,15 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
         return 1;
     }
 
+    // Version 2 adds a checksum of the stop definition (in the
+    // second block) and of the wave data (in the file header).
     memset (data, 0, 16);
     strcpy (data, "ae1");
-    data [4] = 1;
+    data [4] = 2;
     fwrite (data, 1, 16, F);
 
     memset (data, 0, 64);
-    data [0] = 0;
-    data [1] = 0;
-    data [2] = 0;
-    data [3] = 0;
+    *((uint32_t *)(data + 0)) = D->checksum ();
     data [4] = _n0;
     data [5] = _n1;
     data [6] = 0;
@@ -486,8 +501,18 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
     memcpy (data + 16, scale, 12 * sizeof (float));
     fwrite (data, 1, 64, F);
 
-    for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->save (F);
+    h = 2166136261u;
+    for (i = _n0, P = _pipes; i <= _n1; i++, P++) h = P->save (F, h);
 
+    fseek (F, 8, SEEK_SET);
+    fwrite (&h, 1, 4, F);
+    if (ferror (F))
+    {
+	fprintf (stderr, "Can't write waveform file '%s'\n", name);
+        fclose (F);
+        remove (name);
+        return 1;
+    }
     fclose (F);
 
     _modif = false;
@@ -500,6 +525,7 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
     FILE      *F;
     Pipewave  *P;
     int        i;
+    uint32_t   h, csum;
     char       name [1024];
     char       data [64];
     char      *p;
@@ -518,7 +544,7 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         return 1;
     }
 
-    fread (data, 1, 16, F);
+    if (fread (data, 1, 16, F) != 16) data [0] = 0;
     if (strcmp (data, "ae1"))
     {
 #ifdef DEBUG
@@ -528,7 +554,7 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         return 1;
     }
 
-    if (data [4] != 1)
+    if (data [4] != 2)
     {
 #ifdef DEBUG
 	fprintf (stderr, "File '%s' has an incompatible version tag (%d)\n", name, data [4]);
@@ -537,7 +563,21 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         return 1;
     }
 
-    fread (data, 1, 64, F);
+    csum = *((uint32_t *)(data + 8));
+
+    if (fread (data, 1, 64, F) != 64)
+    {
+        fclose (F);
+        return 1;
+    }
+    if (*((uint32_t *)(data + 0)) != D->checksum ())
+    {
+#ifdef DEBUG
+	fprintf (stderr, "File '%s' was generated from a different stop definition\n", name);
+#endif
+        fclose (F);
+        return 1;
+    }
     if (_n0 != data [4] || _n1 != data [5])
     {
 #ifdef DEBUG
@@ -580,10 +620,19 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         }
     }
 
-    for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->load (F);
+    h = 2166136261u;
+    for (i = _n0, P = _pipes; i <= _n1; i++, P++) h = P->load (F, h);
 
     fclose (F);
 
+    if (h != csum)
+    {
+#ifdef DEBUG
+	fprintf (stderr, "File '%s' is corrupted\n", name);
+#endif
+        return 1;
+    }
+
     _modif = false;
     return 0;
 }
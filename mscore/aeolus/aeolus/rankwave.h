@@ -28,6 +28,23 @@
 #define PERIOD 64
 
 
+class Pipewave;
+
+
+// One pipe to be computed by Rankwave::gen_waves (). All pipes
+// are independent and are generated concurrently.
+
+struct Pipejob
+{
+    Pipewave  *_pipe;
+    Addsynth  *_synth;
+    int        _n;
+    float      _fsamp;
+    float      _fpipe;
+    uint32_t   _seed;
+};
+
+
 class Pipewave
 {
 private:
@@ -42,13 +59,14 @@ private:
 
     friend class Rankwave;
 
-    void genwave (Addsynth *D, int n, float fsamp, float fpipe);
-    void save (FILE *F);
-    void load (FILE *F);
+    void genwave (Addsynth *D, int n, float fsamp, float fpipe, uint32_t seed);
+    uint32_t save (FILE *F, uint32_t h);
+    uint32_t load (FILE *F, uint32_t h);
     void play (void);
 
+    static void genjob (Pipejob& J);
     static void looplen (float f, float fsamp, int lmax, int *aa, int *bb);
-    static void attgain (int n, float p);
+    static void attgain (float *att, int n, float p);
 
     float     *_p0;    // attack start
     float     *_p1;    // loop start
@@ -74,11 +92,7 @@ private:
     int16_t    _i_r;   // release count
 
 
-    static void initstatic (float fsamp);
-
     static   Rngen   _rgen;
-    static   float  *_arg;
-    static   float  *_att;
 };
 
 
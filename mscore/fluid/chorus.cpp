@@ -110,12 +110,12 @@ Chorus::Chorus(float sr)
                   if (fabs(i_shifted) < 0.000001) {
                         /* sinc(0) cannot be calculated straightforward (limit needed
                            for 0/0) */
-                        sinc_table[i][ii] = (float)1.;
+                        sinc_table[ii][i] = (float)1.;
                         }
                   else {
-                        sinc_table[i][ii] = (float)sin(i_shifted * M_PI) / (M_PI * i_shifted);
+                        sinc_table[ii][i] = (float)sin(i_shifted * M_PI) / (M_PI * i_shifted);
                         /* Hamming window */
-                        sinc_table[i][ii] *= (float)0.5 * (1.0 + cos(2.0 * M_PI * i_shifted / (float)INTERPOLATION_SAMPLES));
+                        sinc_table[ii][i] *= (float)0.5 * (1.0 + cos(2.0 * M_PI * i_shifted / (float)INTERPOLATION_SAMPLES));
                         }
                   }
             }
@@ -132,6 +132,7 @@ printf("lookup_tab %d\n", (int)(sample_rate / MIN_SPEED_HZ));
 void Chorus::reset()
       {
       memset(chorusbuf, 0, MAX_SAMPLES * sizeof(*chorusbuf));
+      quietSamples  = MAX_SAMPLES;
       number_blocks = 0;
       number_blocks = FLUID_CHORUS_DEFAULT_N;
       level         = FLUID_CHORUS_DEFAULT_LEVEL;
@@ -168,9 +169,13 @@ void Chorus::update()
          (depth_ms / 1000.0  /* convert modulation depth in ms to s*/
          * sample_rate);
 
-      if (modulation_depth_samples > MAX_SAMPLES) {
-            fluid_log(FLUID_WARN, "chorus: Too high depth. Setting it to max (%d).", MAX_SAMPLES);
-            modulation_depth_samples = MAX_SAMPLES;
+      /* process() writes a whole CHORUS_BLOCK into the delay line before
+       * reading it, so the longest delay must leave room for one block
+       */
+      const int max_depth_samples = MAX_SAMPLES - CHORUS_BLOCK - 2 * INTERPOLATION_SAMPLES;
+      if (modulation_depth_samples > max_depth_samples) {
+            fluid_log(FLUID_WARN, "chorus: Too high depth. Setting it to max (%d).", max_depth_samples);
+            modulation_depth_samples = max_depth_samples;
             }
 
       /* initialize LFO table */
@@ -194,60 +199,100 @@ void Chorus::update()
       }
 
 //---------------------------------------------------------
-//   process
+//   silent
+//    true if the delay lines hold nothing but silence
 //---------------------------------------------------------
 
-void Chorus::process(int n, float* in, float* left_out, float* right_out)
+bool Chorus::silent() const
       {
-      for (int sample_index = 0; sample_index < n; sample_index++) {
-            float d_in = in[sample_index];
-            float d_out = 0.0f;
+      return quietSamples >= MAX_SAMPLES;
+      }
 
-            /* Write the current sample into the circular buffer */
-            chorusbuf[counter] = d_in;
+//---------------------------------------------------------
+//   process
+//    The input is handled in blocks of CHORUS_BLOCK samples:
+//    the block is written into the circular buffer first, then
+//    every chorus block adds its delayed signal for all samples
+//    of the block. The summation order per sample is the same
+//    as with a sample by sample loop.
+//---------------------------------------------------------
 
-            for (int i = 0; i < number_blocks; i++) {
-                  /* Calculate the delay in subsamples for the delay line of chorus block nr. */
+void Chorus::process(int n, const float* in, float* left_out, float* right_out)
+      {
+      float d_out[CHORUS_BLOCK];
+
+      for (int k0 = 0; k0 < n; k0 += CHORUS_BLOCK) {
+            int m          = qMin(n - k0, CHORUS_BLOCK);
+            const float* p = in + k0;
+
+            float peak = 0.0f;
+            for (int k = 0; k < m; ++k)
+                  peak = qMax(peak, fabsf(p[k]));
+            if (peak >= FLUID_SILENCE_THRESHOLD)
+                  quietSamples = 0;
+            else if (silent()) {
+                  /* the delay line is empty: only keep the LFOs and the
+                   * buffer position running */
+                  for (int i = 0; i < number_blocks; i++)
+                        phase[i] = (phase[i] + m) % modulation_period_samples;
+                  counter = (counter + m) & MAX_SAMPLES_ANDMASK;
+                  continue;
+                  }
+            else
+                  quietSamples += m;
 
-                  /* The value in the lookup table is so, that this expression
-                   * will always be positive.  It will always include a number of
-                   * full periods of MAX_SAMPLES*INTERPOLATION_SUBSAMPLES to
-                   * remain positive at all times.
-                   */
-                  int pos_subsamples = (INTERPOLATION_SUBSAMPLES * counter
-                     - lookup_tab[phase[i]]);
+            /* Write the current block into the circular buffer */
+            for (int k = 0; k < m; ++k) {
+                  chorusbuf[(counter + k) & MAX_SAMPLES_ANDMASK] = p[k];
+                  d_out[k] = 0.0f;
+                  }
 
-                  int pos_samples = pos_subsamples/INTERPOLATION_SUBSAMPLES;
+            for (int i = 0; i < number_blocks; i++) {
+                  long ph = phase[i];
+                  for (int k = 0; k < m; ++k) {
+                        /* Calculate the delay in subsamples for the delay line of chorus block nr. */
+
+                        /* The value in the lookup table is so, that this expression
+                         * will always be positive.  It will always include a number of
+                         * full periods of MAX_SAMPLES*INTERPOLATION_SUBSAMPLES to
+                         * remain positive at all times.
+                         */
+                        int pos_subsamples = (INTERPOLATION_SUBSAMPLES * ((counter + k) & MAX_SAMPLES_ANDMASK)
+                           - lookup_tab[ph]);
 
-                  /* modulo divide by INTERPOLATION_SUBSAMPLES */
-                  pos_subsamples &= INTERPOLATION_SUBSAMPLES_ANDMASK;
+                        int pos_samples = pos_subsamples/INTERPOLATION_SUBSAMPLES;
 
-                  for (int ii = 0; ii < INTERPOLATION_SAMPLES; ii++) {
-	                  /* Add the delayed signal to the chorus sum d_out Note: The
-	                   * delay in the delay line moves backwards for increasing
-	                   * delay!*/
+                        /* modulo divide by INTERPOLATION_SUBSAMPLES */
+                        const float* sinc = sinc_table[pos_subsamples & INTERPOLATION_SUBSAMPLES_ANDMASK];
 
-	                  /* The & in chorusbuf[...] is equivalent to a division modulo
-	                     MAX_SAMPLES, only faster.
+                        /* Add the delayed signal to the chorus sum d_out Note: The
+                         * delay in the delay line moves backwards for increasing
+                         * delay! The & in chorusbuf[...] is equivalent to a division
+                         * modulo MAX_SAMPLES, only faster.
                          */
-                        d_out += (chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
-                           * sinc_table[ii][pos_subsamples]);
-                        pos_samples--;
+                        float d = d_out[k];
+                        for (int ii = 0; ii < INTERPOLATION_SAMPLES; ii++)
+                              d += chorusbuf[(pos_samples - ii) & MAX_SAMPLES_ANDMASK] * sinc[ii];
+                        d_out[k] = d;
+
+                        /* Cycle the phase of the modulating LFO */
+                        if (++ph >= modulation_period_samples)
+                              ph = 0;
                         }
-                  /* Cycle the phase of the modulating LFO */
-                  phase[i]++;
-                  phase[i] %= (modulation_period_samples);
+                  phase[i] = ph;
                   } /* foreach chorus block */
 
-            d_out *= level;
-
             /* Add the chorus sum d_out to output */
-            left_out[sample_index]  += d_out;
-            right_out[sample_index] += d_out;
+            float* l = left_out + k0;
+            float* r = right_out + k0;
+            for (int k = 0; k < m; ++k) {
+                  float v = d_out[k] * level;
+                  l[k] += v;
+                  r[k] += v;
+                  }
 
             /* Move forward in circular buffer */
-            counter++;
-            counter %= MAX_SAMPLES;
+            counter = (counter + m) & MAX_SAMPLES_ANDMASK;
             }
       }
 
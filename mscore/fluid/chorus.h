@@ -41,6 +41,9 @@ namespace FluidS {
 */
 #define INTERPOLATION_SAMPLES 5
 
+/* Number of samples rendered per pass over the chorus blocks */
+#define CHORUS_BLOCK 64
+
 
 //---------------------------------------------------------
 //   Chorus
@@ -71,17 +74,19 @@ class Chorus {
       long modulation_period_samples;
       int* lookup_tab;
       float sample_rate;
+      int quietSamples;       /* consecutive samples of silent input */
 
-      /* sinc lookup table */
-      float sinc_table[INTERPOLATION_SAMPLES][INTERPOLATION_SUBSAMPLES];
+      /* sinc lookup table, the taps for one subsample offset are adjacent */
+      float sinc_table[INTERPOLATION_SUBSAMPLES][INTERPOLATION_SAMPLES];
 
    public:
       Chorus(float sample_rate);
       ~Chorus();
 
       void update();
-      void process(int, float *in, float *left_out, float *right_out);
+      void process(int, const float *in, float *left_out, float *right_out);
       void reset();
+      bool silent() const;
 
       int get_nr() const         { return number_blocks; }
       float get_level() const    { return level;    }
@@ -19,6 +19,7 @@
  */
 
 #include "libmscore/event.h"
+#include "libmscore/dsp.h"
 #include "fluid.h"
 #include "sfont.h"
 #include "conv.h"
@@ -90,7 +91,6 @@ Fluid::Fluid()
       fx_buf[1] = new float[FLUID_MAX_BUFSIZE];
       reverb    = 0;
       chorus    = 0;
-      silentBlocks = 0;
       }
 
 //---------------------------------------------------------
@@ -504,23 +504,16 @@ void Fluid::process(unsigned len, float* lout, float* rout, float gain)
       memset(fx_buf[1], 0, byte_size);
 
       if (mutex.tryLock()) {
-            if (activeVoices.isEmpty())
-                  silentBlocks--;
-            else {
-                  silentBlocks = SILENT_BLOCKS;
-                  foreach (Voice* v, activeVoices)
-                        v->write(len, left_buf, right_buf, fx_buf[0], fx_buf[1]);
-                  }
-            if (silentBlocks > 0) {
-                  reverb->process(len, fx_buf[0], left_buf, right_buf);
-                  chorus->process(len, fx_buf[1], left_buf, right_buf);
-                  }
+            foreach (Voice* v, activeVoices)
+                  v->write(len, left_buf, right_buf, fx_buf[0], fx_buf[1]);
+            // the effects skip their work on their own once the
+            // input and the tail have become silent
+            reverb->process(len, fx_buf[0], left_buf, right_buf);
+            chorus->process(len, fx_buf[1], left_buf, right_buf);
             mutex.unlock();
             }
-      for (unsigned i = 0; i < len; i++) {
-            *lout++ += gain * left_buf[i];
-            *rout++ += gain * right_buf[i];
-            }
+      dsp->mixWithGain(lout, left_buf, len, gain);
+      dsp->mixWithGain(rout, right_buf, len, gain);
       }
 
 /*
@@ -40,6 +40,10 @@ class Fluid;
 #define FLUID_MAX_BUFSIZE       4096
 #define FLUID_NUM_PROGRAMS      129
 
+// effect input and output below this level (-100dB) is treated as
+// silence by the reverb and the chorus
+#define FLUID_SILENCE_THRESHOLD 1e-5f
+
 enum fluid_loop {
       FLUID_UNLOOPED            = 0,
       FLUID_LOOP_DURING_RELEASE = 1,
@@ -313,9 +317,6 @@ enum {
 //---------------------------------------------------------
 
 class Fluid : public Synth {
-      static const int SILENT_BLOCKS = 32*5;
-      int silentBlocks;
-
       QList<SFont*> sfonts;               // the loaded soundfonts
       QList<BankOffset*> bank_offsets;    // the offsets of the soundfont banks
       QList<MidiPatch*> patches;
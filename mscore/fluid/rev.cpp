@@ -47,6 +47,33 @@ void Allpass::init()
             buffer[i] = DC_OFFSET;  // this is not 100 % correct.
       }
 
+//---------------------------------------------------------
+//   process
+//    filter n samples in place; the delay line is walked
+//    in runs up to its wrap point
+//---------------------------------------------------------
+
+void Allpass::process(int n, float* io)
+      {
+      int idx = bufidx;
+      for (int k = 0; k < n;) {
+            int run  = qMin(n - k, bufsize - idx);
+            float* b = buffer + idx;
+            float* p = io + k;
+            for (int i = 0; i < run; ++i) {
+                  float bufout = b[i];
+                  float input  = p[i];
+                  b[i]         = input + (bufout * feedback);
+                  p[i]         = bufout - input;
+                  }
+            k   += run;
+            idx += run;
+            if (idx >= bufsize)
+                  idx = 0;
+            }
+      bufidx = idx;
+      }
+
 void Comb::setbuffer(int size)
       {
       filterstore = 0;
@@ -67,6 +94,63 @@ void Comb::setdamp(float val)
       damp2 = 1 - val;
       }
 
+//---------------------------------------------------------
+//   process
+//    Add the output of four combs for n input samples to
+//    out. The filters are run side by side so that their
+//    feedback chains overlap; the inner loop runs up to the
+//    next wrap point of any of the delay lines.
+//---------------------------------------------------------
+
+void Comb::process(Comb* c, int n, const float* input, float* out)
+      {
+      float s0 = c[0].filterstore;
+      float s1 = c[1].filterstore;
+      float s2 = c[2].filterstore;
+      float s3 = c[3].filterstore;
+      const float d1 = c[0].damp1;        // damp and feedback are the same
+      const float d2 = c[0].damp2;        // for all combs of a reverb
+      const float fb = c[0].feedback;
+
+      for (int k = 0; k < n;) {
+            int run = n - k;
+            for (int j = 0; j < 4; ++j)
+                  run = qMin(run, c[j].bufsize - c[j].bufidx);
+            float* b0 = c[0].buffer + c[0].bufidx;
+            float* b1 = c[1].buffer + c[1].bufidx;
+            float* b2 = c[2].buffer + c[2].bufidx;
+            float* b3 = c[3].buffer + c[3].bufidx;
+            const float* p = input + k;
+            float* o       = out + k;
+            for (int i = 0; i < run; ++i) {
+                  float in  = p[i];
+                  float t0  = b0[i];
+                  float t1  = b1[i];
+                  float t2  = b2[i];
+                  float t3  = b3[i];
+                  s0        = (t0 * d2) + (s0 * d1);
+                  s1        = (t1 * d2) + (s1 * d1);
+                  s2        = (t2 * d2) + (s2 * d1);
+                  s3        = (t3 * d2) + (s3 * d1);
+                  b0[i]     = in + (s0 * fb);
+                  b1[i]     = in + (s1 * fb);
+                  b2[i]     = in + (s2 * fb);
+                  b3[i]     = in + (s3 * fb);
+                  o[i]      = o[i] + t0 + t1 + t2 + t3;
+                  }
+            k += run;
+            for (int j = 0; j < 4; ++j) {
+                  c[j].bufidx += run;
+                  if (c[j].bufidx >= c[j].bufsize)
+                        c[j].bufidx = 0;
+                  }
+            }
+      c[0].filterstore = s0;
+      c[1].filterstore = s1;
+      c[2].filterstore = s2;
+      c[3].filterstore = s3;
+      }
+
 static const int stereospread = 23;
 
 /*
@@ -101,6 +185,11 @@ Reverb::Reverb()
             allpassL[i].setfeedback(0.5f);
             allpassR[i].setfeedback(0.5f);
             }
+      // a silent input has to run through the longest comb and all
+      // allpasses before the output can be trusted to stay silent
+      tailSamples = combR[numcombs-1].size();
+      for (int i = 0; i < numallpasses; ++i)
+            tailSamples += allpassR[i].size();
       gain = 0.30;      // input gain
       setPreset(0);
       init();           // Clear all buffers
@@ -121,13 +210,14 @@ void Reverb::init()
             allpassL[i].init();
             allpassR[i].init();
             }
+      quietSamples = tailSamples;
       }
 
 //---------------------------------------------------------
 //   process
 //---------------------------------------------------------
 
-void Reverb::process(int n, float* in, float* l, float* r)
+void Reverb::process(int n, const float* in, float* l, float* r)
       {
       if (parameterChanged) {
             roomsize = newRoomsize;
@@ -137,28 +227,48 @@ void Reverb::process(int n, float* in, float* l, float* r)
             update();
             parameterChanged = false;
             }
-      for (int k = 0; k < n; k++) {
-            float outL = 0.0;
-            float outR = 0.0;
-
-            float input = (in[k] * 2.0 + DC_OFFSET) * gain;
-
-            for (int i = 0; i < numcombs; i++) {      // Accumulate comb filters in parallel
-                  outL += combL[i].process(input);
-                  outR += combR[i].process(input);
+      float input[revblocksize];
+      float outL[revblocksize];
+      float outR[revblocksize];
+
+      for (int k0 = 0; k0 < n; k0 += revblocksize) {
+            int m          = qMin(n - k0, revblocksize);
+            const float* p = in + k0;
+
+            float peak = 0.0f;
+            for (int k = 0; k < m; ++k)
+                  peak = qMax(peak, fabsf(p[k]));
+            if (peak < FLUID_SILENCE_THRESHOLD && silent())
+                  continue;         // tail has died away, nothing to add
+
+            for (int k = 0; k < m; ++k) {
+                  input[k] = (p[k] * 2.0 + DC_OFFSET) * gain;
+                  outL[k]  = 0.0f;
+                  outR[k]  = 0.0f;
+                  }
+            for (int i = 0; i < numcombs; i += 4) {      // Accumulate comb filters in parallel
+                  Comb::process(combL + i, m, input, outL);
+                  Comb::process(combR + i, m, input, outR);
                   }
             for (int i = 0; i < numallpasses; i++) {  // Feed through allpasses in series
-                  outL = allpassL[i].process(outL);
-                  outR = allpassR[i].process(outR);
+                  allpassL[i].process(m, outL);
+                  allpassR[i].process(m, outR);
                   }
 
-            /* Remove the DC offset */
-            outL -= DC_OFFSET;
-            outR -= DC_OFFSET;
-
-            /* Calculate output MIXING with anything already there */
-            l[k] += outL * wet1 + outR * wet2;
-            r[k] += outR * wet1 + outL * wet2;
+            /* Remove the DC offset and calculate output MIXING with anything already there */
+            float* lo = l + k0;
+            float* ro = r + k0;
+            for (int k = 0; k < m; ++k) {
+                  float oL = outL[k] - DC_OFFSET;
+                  float oR = outR[k] - DC_OFFSET;
+                  peak     = qMax(peak, qMax(fabsf(oL), fabsf(oR)));
+                  lo[k]   += oL * wet1 + oR * wet2;
+                  ro[k]   += oR * wet1 + oL * wet2;
+                  }
+            if (peak >= FLUID_SILENCE_THRESHOLD)
+                  quietSamples = 0;
+            else if (quietSamples < tailSamples)
+                  quietSamples += m;
             }
       }
 
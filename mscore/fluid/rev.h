@@ -42,15 +42,8 @@ class Allpass {
       void init();
       void setfeedback(float val) { feedback = val;  }
       float getfeedback() const   { return feedback; }
-
-      float process(float _input) {
-            float bufout = buffer[bufidx];
-            float output = bufout - _input;
-            buffer[bufidx] = _input + (bufout * feedback);
-            if (++bufidx >= bufsize)
-                  bufidx = 0;
-            return output;
-            }
+      int size() const            { return bufsize;  }
+      void process(int n, float* io);
       };
 
 //---------------------------------------------------------
@@ -73,15 +66,8 @@ class Comb {
       float getdamp() const       { return damp1;    }
       void setfeedback(float val) { feedback = val;  }
       float getfeedback() const   { return feedback; }
-
-      float process(float input) {
-            float tmp = buffer[bufidx];
-            filterstore      = (tmp * damp2) + (filterstore * damp1);
-            buffer[bufidx]   = input + (filterstore * feedback);
-            if (++bufidx >= bufsize)
-                  bufidx = 0;
-            return tmp;
-            }
+      int size() const            { return bufsize;  }
+      static void process(Comb* c, int n, const float* input, float* out);
       };
 
 static const float scaleroom  = 0.28f;
@@ -89,6 +75,8 @@ static const float offsetroom = 0.7f;
 static const float scalewet   = 3.0f;
 static const float scaledamp  = 0.4f;
 
+static const int revblocksize = 128;      // samples processed per filter pass
+
 //---------------------------------------------------------
 //   Reverb
 //---------------------------------------------------------
@@ -109,6 +97,9 @@ class Reverb {
       float newGain;
       bool parameterChanged;
 
+      int tailSamples;        ///< longest path through combs and allpasses
+      int quietSamples;       ///< number of consecutive silent in/out samples
+
       /*
        The following are all declared inline
        to remove the need for dynamic allocation
@@ -123,9 +114,10 @@ class Reverb {
 
    public:
       Reverb();
-      void process(int n, float* in, float* left_out, float* right_out);
+      void process(int n, const float* in, float* left_out, float* right_out);
 
       void reset() { init(); }
+      bool silent() const { return quietSamples >= tailSamples; }
 
       void setroomsize(float value) { roomsize = (value * scaleroom) + offsetroom; }
       void setdamp(float value)     { damp = value * scaledamp;  }
@@ -26,7 +26,7 @@ class InsertItemBspTreeVisitor : public BspTreeVisitor
    public:
       const Element* item;
 
-      inline void visit(QList<const Element*> *items) { items->prepend(item); }
+      inline void visit(QVector<const Element*>* items) { items->append(item); }
       };
 
 //---------------------------------------------------------
@@ -38,7 +38,11 @@ class RemoveItemBspTreeVisitor : public BspTreeVisitor
    public:
       const Element* item;
 
-      inline void visit(QList<const Element*> *items) { items->removeAll(item); }
+      inline void visit(QVector<const Element*>* items) {
+            int idx = items->indexOf(item);
+            if (idx != -1)
+                  items->remove(idx);
+            }
       };
 
 //---------------------------------------------------------
@@ -48,14 +52,16 @@ class RemoveItemBspTreeVisitor : public BspTreeVisitor
 class FindItemBspTreeVisitor : public BspTreeVisitor
       {
    public:
-      QList<const Element*>* foundItems;
+      QVector<const Element*> foundItems;
+      QVector<int> chunks;          // start of the items found in each leaf
 
-      void visit(QList<const Element*>* items) {
+      void visit(QVector<const Element*>* items) {
+            chunks.append(foundItems.size());
             for (int i = 0; i < items->size(); ++i) {
                   const Element* item = items->at(i);
                   if (!item->itemDiscovered) {
                         item->itemDiscovered = 1;
-                        foundItems->prepend(item);
+                        foundItems.append(item);
                         }
                   }
             }
@@ -102,7 +108,7 @@ void BspTree::initialize(const QRectF& rect, int n)
 
       nodes.resize((1 << (depth+1)) - 1);
       leaves.resize(1 << depth);
-      leaves.fill(QList<const Element*>());
+      leaves.fill(QVector<const Element*>());
       initialize(rect, depth, 0);
       }
 
@@ -137,6 +143,30 @@ void BspTree::remove(const Element* element)
       climbTree(removeVisitor, element->pageBoundingRect());
       }
 
+//---------------------------------------------------------
+//   remove
+//    remove element which was inserted with bounding
+//    rectangle r; used for elements which moved since
+//---------------------------------------------------------
+
+void BspTree::remove(const Element* element, const QRectF& r)
+      {
+      removeVisitor->item = element;
+      climbTree(removeVisitor, r);
+      }
+
+//---------------------------------------------------------
+//   update
+//    move element from the leaves covering oldRect to
+//    the leaves covering its current page bounding rect
+//---------------------------------------------------------
+
+void BspTree::update(const Element* element, const QRectF& oldRect)
+      {
+      remove(element, oldRect);
+      insert(element);
+      }
+
 //---------------------------------------------------------
 //   remove
 //---------------------------------------------------------
@@ -163,10 +193,8 @@ void BspTree::remove(const QSet<const Element*>& items)
 
 QList<const Element*> BspTree::items(const QRectF& rect)
       {
-      QList<const Element*> tmp;
-      findVisitor->foundItems = &tmp;
       climbTree(findVisitor, rect);
-      return tmp;
+      return foundItems();
       }
 
 //---------------------------------------------------------
@@ -175,9 +203,8 @@ QList<const Element*> BspTree::items(const QRectF& rect)
 
 QList<const Element*> BspTree::items(const QPointF& pos)
       {
-      QList<const Element*> tmp;
-      findVisitor->foundItems = &tmp;
       climbTree(findVisitor, pos);
+      QList<const Element*> tmp = foundItems();
 
       QList<const Element*> l;
       for (int i = 0; i < tmp.size(); ++i) {
@@ -189,6 +216,52 @@ QList<const Element*> BspTree::items(const QPointF& pos)
       return l;
       }
 
+//---------------------------------------------------------
+//   foundItems
+//    collect the result of the last find visit; the items
+//    of the leaf visited last come first, as the result
+//    order is the drawing order for equal stacking levels
+//---------------------------------------------------------
+
+QList<const Element*> BspTree::foundItems()
+      {
+      const QVector<const Element*>& found = findVisitor->foundItems;
+      QVector<int>& chunks = findVisitor->chunks;
+      QList<const Element*> l;
+      int end = found.size();
+      for (int i = chunks.size() - 1; i >= 0; --i) {
+            int start = chunks[i];
+            for (int k = start; k < end; ++k)
+                  l.append(found[k]);
+            end = start;
+            }
+      findVisitor->foundItems.clear();
+      chunks.clear();
+      return l;
+      }
+
+//---------------------------------------------------------
+//   statistics
+//---------------------------------------------------------
+
+BspTree::Statistics BspTree::statistics() const
+      {
+      Statistics st;
+      st.nodes       = nodes.size();
+      st.leaves      = leafCnt;
+      st.items       = 0;
+      st.emptyLeaves = 0;
+      st.maxItems    = 0;
+      for (int i = 0; i < leafCnt; ++i) {
+            int n = leaves[i].size();
+            st.items += n;
+            if (n == 0)
+                  ++st.emptyLeaves;
+            st.maxItems = qMax(st.maxItems, n);
+            }
+      return st;
+      }
+
 //---------------------------------------------------------
 //   debug
 //---------------------------------------------------------
@@ -32,6 +32,14 @@ class Element;
 class BspTree
       {
    public:
+      struct Statistics {
+            int nodes;              ///< number of tree nodes
+            int leaves;             ///< number of leaves
+            int items;              ///< leaf entries; items spanning leaves count once per leaf
+            int emptyLeaves;
+            int maxItems;           ///< entries in the fullest leaf
+            };
+
       struct Node {
             enum Type { Horizontal, Vertical, Leaf };
             union {
@@ -46,12 +54,11 @@ class BspTree
       void climbTree(BspTreeVisitor* visitor, const QPointF& pos, int index = 0);
       void climbTree(BspTreeVisitor* visitor, const QRectF& rect, int index = 0);
 
-      void findItems(QList<const Element*>* foundItems, const QRectF& rect, int index);
-      void findItems(QList<const Element*>* foundItems, const QPointF& pos, int index);
       QRectF rectForIndex(int index) const;
+      QList<const Element*> foundItems();
 
       QVector<Node> nodes;
-      QVector<QList<const Element*> > leaves;
+      QVector<QVector<const Element*> > leaves;
       int leafCnt;
       QRectF rect;
 
@@ -68,12 +75,15 @@ class BspTree
 
       void insert(const Element* item);
       void remove(const Element* item);
+      void remove(const Element* item, const QRectF& r);
+      void update(const Element* item, const QRectF& oldRect);
 //      void remove(const QSet<const Element*>& items);
 
       QList<const Element*> items(const QRectF& rect);
       QList<const Element*> items(const QPointF& pos);
 
       int leafCount() const                       { return leafCnt; }
+      Statistics statistics() const;
       inline int firstChildIndex(int index) const { return index * 2 + 1; }
 
       inline int parentIndex(int index) const {
@@ -91,7 +101,7 @@ class BspTreeVisitor
       {
    public:
       virtual ~BspTreeVisitor() {}
-      virtual void visit(QList<const Element*>* items) = 0;
+      virtual void visit(QVector<const Element*>* items) = 0;
       };
 
 #endif
@@ -15,6 +15,9 @@
 #include "xml.h"
 #include "pitchspelling.h"
 #include "mscore.h"
+#include "datacache.h"
+
+static const int CHORD_CACHE_VERSION = 1;       // bump on format change
 
 //---------------------------------------------------------
 //   HChord
@@ -341,6 +344,37 @@ static void writeRenderList(Xml& xml, const QList<RenderAction>* al, const QStri
       xml.tag(name, s);
       }
 
+//---------------------------------------------------------
+//   writeRenderList
+//---------------------------------------------------------
+
+static void writeRenderList(QDataStream& s, const QList<RenderAction>& al)
+      {
+      s << qint32(al.size());
+      foreach(const RenderAction& a, al)
+            s << qint32(a.type) << double(a.movex) << double(a.movey) << a.text;
+      }
+
+//---------------------------------------------------------
+//   readRenderList
+//---------------------------------------------------------
+
+static void readRenderList(QDataStream& s, QList<RenderAction>* al)
+      {
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            qint32 type;
+            double movex, movey;
+            RenderAction a;
+            s >> type >> movex >> movey >> a.text;
+            a.type  = RenderAction::RenderActionType(type);
+            a.movex = movex;
+            a.movey = movey;
+            al->append(a);
+            }
+      }
+
 //---------------------------------------------------------
 //   read
 //---------------------------------------------------------
@@ -383,6 +417,29 @@ void ChordDescription::write(Xml& xml)
       xml.etag();
       }
 
+//---------------------------------------------------------
+//   writeCache
+//---------------------------------------------------------
+
+void ChordDescription::writeCache(QDataStream& s) const
+      {
+      s << qint32(id) << names << xmlKind << xmlDegrees << qint32(chord.getKeys());
+      writeRenderList(s, renderList);
+      }
+
+//---------------------------------------------------------
+//   readCache
+//---------------------------------------------------------
+
+void ChordDescription::readCache(QDataStream& s)
+      {
+      qint32 i, keys;
+      s >> i >> names >> xmlKind >> xmlDegrees >> keys;
+      id    = i;
+      chord = HChord(keys);
+      readRenderList(s, &renderList);
+      }
+
 //---------------------------------------------------------
 //   ~ChordList
 //---------------------------------------------------------
@@ -473,11 +530,10 @@ void ChordList::write(Xml& xml)
       }
 
 //---------------------------------------------------------
-//   read
-//    read Chord List, return false on error
+//   chordListPath
 //---------------------------------------------------------
 
-bool ChordList::read(const QString& name)
+static QString chordListPath(const QString& name)
       {
       QString path;
       QFileInfo ftest(name);
@@ -489,6 +545,17 @@ bool ChordList::read(const QString& name)
       QFileInfo fi(path);
       if(!fi.exists())
             path = QString("%1styles/%2").arg(MScore::globalShare()).arg("stdchords.xml");
+      return path;
+      }
+
+//---------------------------------------------------------
+//   read
+//    read Chord List, return false on error
+//---------------------------------------------------------
+
+bool ChordList::read(const QString& name)
+      {
+      QString path = chordListPath(name);
       if (debugMode)
             printf("read chordlist from <%s>\n", qPrintable(path));
       if (name.isEmpty())
@@ -521,6 +588,101 @@ bool ChordList::read(const QString& name)
       return false;
       }
 
+//---------------------------------------------------------
+//   writeCache
+//---------------------------------------------------------
+
+void ChordList::writeCache(QDataStream& s) const
+      {
+      s << qint32(fonts.size());
+      foreach(const ChordFont& f, fonts)
+            s << f.family << double(f.mag);
+      s << qint32(symbols.size());
+      foreach(const ChordSymbol& cs, symbols)
+            s << qint32(cs.fontIdx) << cs.name << quint16(cs.code.unicode());
+      writeRenderList(s, renderListRoot);
+      writeRenderList(s, renderListBase);
+      s << qint32(size());
+      foreach(const ChordDescription* cd, *this)
+            cd->writeCache(s);
+      }
+
+//---------------------------------------------------------
+//   readCache
+//    return false if the cache is damaged
+//---------------------------------------------------------
+
+bool ChordList::readCache(QDataStream& s)
+      {
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            ChordFont f;
+            double mag;
+            s >> f.family >> mag;
+            f.mag = mag;
+            fonts.append(f);
+            }
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            ChordSymbol cs;
+            qint32 fontIdx;
+            quint16 code;
+            s >> fontIdx >> cs.name >> code;
+            cs.fontIdx = fontIdx;
+            cs.code    = QChar(code);
+            symbols.insert(cs.name, cs);
+            }
+      readRenderList(s, &renderListRoot);
+      readRenderList(s, &renderListBase);
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            ChordDescription* cd = new ChordDescription;
+            cd->readCache(s);
+            insert(cd->id, cd);
+            }
+      return s.status() == QDataStream::Ok;
+      }
+
+//---------------------------------------------------------
+//   readCached
+//    read the chord list files names into an empty
+//    ChordList; the result is kept in a binary cache
+//    which is used as long as none of the files changes
+//---------------------------------------------------------
+
+bool ChordList::readCached(const QStringList& names)
+      {
+      QStringList sources;
+      foreach(const QString& name, names) {
+            if (!name.isEmpty())
+                  sources.append(chordListPath(name));
+            }
+      DataCache cache("chords", CHORD_CACHE_VERSION, sources);
+      QDataStream* s = cache.read();
+      if (s) {
+            if (readCache(*s))
+                  return true;
+            printf("damaged chord list cache\n");
+            qDeleteAll(*this);
+            clear();
+            symbols.clear();
+            fonts.clear();
+            renderListRoot.clear();
+            renderListBase.clear();
+            }
+      bool ok = true;
+      foreach(const QString& name, names) {
+            if (!name.isEmpty() && !read(name))
+                  ok = false;
+            }
+      if (ok && (s = cache.write())) {
+            writeCache(*s);
+            cache.commit();
+            }
+      return ok;
+      }
+
 //---------------------------------------------------------
 //   writeChordList
 //---------------------------------------------------------
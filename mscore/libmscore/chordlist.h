@@ -112,6 +112,8 @@ struct ChordDescription {
    public:
       void read(QDomElement);
       void write(Xml&);
+      void readCache(QDataStream&);
+      void writeCache(QDataStream&) const;
       };
 
 //---------------------------------------------------------
@@ -143,6 +145,9 @@ struct ChordFont {
 class ChordList : public QMap<int, ChordDescription*> {
       QHash<QString, ChordSymbol> symbols;
 
+      bool readCache(QDataStream&);
+      void writeCache(QDataStream&) const;
+
    public:
       QList<ChordFont> fonts;
       QList<RenderAction> renderListRoot;
@@ -154,6 +159,7 @@ class ChordList : public QMap<int, ChordDescription*> {
       void write(Xml& xml);
       void read(QDomElement);
       bool read(const QString&);
+      bool readCached(const QStringList&);
       bool write(const QString&);
       ChordSymbol symbol(const QString& s) const { return symbols.value(s); }
       };
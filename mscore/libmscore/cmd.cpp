@@ -114,8 +114,14 @@ void Score::endCmd()
             }
       Score* score = rootScore();
       score->end2();
-      foreach(Excerpt* e, score->_excerpts)
-            e->score()->end2();
+      foreach(Excerpt* e, score->_excerpts) {
+            Score* s = e->score();
+            // excerpts not shown in any view are layed out on demand
+            if (s->viewer.isEmpty())
+                  s->deferLayout();
+            else
+                  s->end2();
+            }
 
       bool noUndo = undo()->current()->childCount() <= 1;
       if (!noUndo)
@@ -162,6 +168,37 @@ void Score::end2()
       startLayout = 0;
       }
 
+//---------------------------------------------------------
+//   deferLayout
+///   Remember a pending relayout instead of doing it now.
+///   startLayout may point to a measure which is removed
+///   by a later command, so a deferred layout is always
+///   a complete relayout.
+//---------------------------------------------------------
+
+void Score::deferLayout()
+      {
+      if (_layoutAll || startLayout)
+            _layoutPending = true;
+      _layoutAll  = false;
+      startLayout = 0;
+      }
+
+//---------------------------------------------------------
+//   doPendingLayout
+///   Do a deferred layout. Must be called before the
+///   score is shown, printed or exported.
+//---------------------------------------------------------
+
+void Score::doPendingLayout()
+      {
+      if (!_layoutPending)
+            return;
+      _layoutPending = false;
+      _layoutAll     = true;
+      end2();
+      }
+
 //---------------------------------------------------------
 //   end1
 //---------------------------------------------------------
@@ -169,6 +206,7 @@ void Score::end2()
 void Score::end1()
       {
       if (_updateAll) {
+            rebuildBspTree();
             foreach(MuseScoreView* v, viewer)
                   v->updateAll();
             }
@@ -176,6 +214,8 @@ void Score::end1()
             // update a little more:
             qreal d = spatium() * .5;
             refresh.adjust(-d, -d, 2 * d, 2 * d);
+            // elements may have changed their bbox without relayout
+            rebuildBspTree(refresh);
             foreach(MuseScoreView* v, viewer)
                   v->dataChanged(refresh);
             }
@@ -0,0 +1,131 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "cursormap.h"
+#include "score.h"
+#include "measure.h"
+#include "segment.h"
+#include "repeatlist.h"
+
+//---------------------------------------------------------
+//   CursorMap
+//---------------------------------------------------------
+
+CursorMap::CursorMap()
+      {
+      _valid = false;
+      _hint  = 0;
+      }
+
+//---------------------------------------------------------
+//   append
+//---------------------------------------------------------
+
+void CursorMap::append(int utick, qreal x, Measure* m)
+      {
+      Entry e;
+      e.utick   = utick;
+      e.x       = x;
+      e.measure = m;
+      _entries.append(e);
+      }
+
+//---------------------------------------------------------
+//   addMeasure
+//    add all chord/rest segments of m and the end of
+//    the measure; offset converts ticks to uticks
+//---------------------------------------------------------
+
+void CursorMap::addMeasure(Measure* m, int offset)
+      {
+      if (m->system() == 0)         // not laid out
+            return;
+      for (Segment* s = m->first(SegChordRest); s; s = s->next(SegChordRest))
+            append(s->tick() + offset, s->canvasPos().x(), m);
+      append(m->endTick() + offset, m->canvasPos().x() + m->width(), 0);
+      }
+
+//---------------------------------------------------------
+//   build
+//---------------------------------------------------------
+
+void CursorMap::build(Score* score)
+      {
+      _entries.clear();
+      _hint = 0;
+      const RepeatList* rl = score->repeatList();
+      if (rl->isEmpty()) {
+            // not unwound yet: uticks are ticks
+            for (Measure* m = score->firstMeasure(); m; m = m->nextMeasure())
+                  addMeasure(m, 0);
+            }
+      else {
+            foreach(const RepeatSegment* rs, *rl) {
+                  int offset  = rs->utick - rs->tick;
+                  int endTick = rs->tick + rs->len;
+                  for (Measure* m = score->tick2measure(rs->tick); m && m->tick() < endTick; m = m->nextMeasure())
+                        addMeasure(m, offset);
+                  }
+            }
+      _valid = true;
+      }
+
+//---------------------------------------------------------
+//   find
+//    return the measure at utick and the interpolated
+//    cursor position in x; return zero if utick is not
+//    inside a measure
+//
+//    Playback moves forward, so first try the entry of
+//    the last lookup and its successor before doing a
+//    binary search.
+//---------------------------------------------------------
+
+Measure* CursorMap::find(int utick, qreal* x) const
+      {
+      int n = _entries.size();
+      if (n == 0)
+            return 0;
+      //
+      // find the last entry with entry.utick <= utick
+      //
+      int idx = -1;
+      for (int i = _hint; i < _hint + 2 && i < n; ++i) {
+            if (_entries[i].utick <= utick && (i + 1 == n || _entries[i+1].utick > utick)) {
+                  idx = i;
+                  break;
+                  }
+            }
+      if (idx == -1) {
+            int lo = 0;
+            int hi = n;
+            while (lo < hi) {
+                  int mid = (lo + hi) / 2;
+                  if (_entries[mid].utick <= utick)
+                        lo = mid + 1;
+                  else
+                        hi = mid;
+                  }
+            idx = lo - 1;
+            if (idx < 0)
+                  return 0;
+            }
+      _hint = idx;
+      const Entry& e = _entries[idx];
+      if (e.measure == 0 || idx + 1 == n)
+            return 0;
+      const Entry& ne = _entries[idx + 1];
+      *x = e.x + (ne.x - e.x) * (utick - e.utick) / (ne.utick - e.utick);
+      return e.measure;
+      }
+
@@ -0,0 +1,50 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __CURSORMAP_H__
+#define __CURSORMAP_H__
+
+class Score;
+class Measure;
+
+//---------------------------------------------------------
+//   CursorMap
+//    maps unrolled ticks to the horizontal position of the
+//    playback cursor; built once after layout from the
+//    chord/rest segments of all measures in playback
+//    (repeat) order
+//---------------------------------------------------------
+
+class CursorMap {
+      struct Entry {
+            int utick;
+            qreal x;                ///< canvas position
+            Measure* measure;       ///< zero for the end of measure
+            };
+      QVector<Entry> _entries;
+      bool _valid;
+      mutable int _hint;            ///< index of last lookup
+
+      void append(int utick, qreal x, Measure* m);
+      void addMeasure(Measure*, int offset);
+
+   public:
+      CursorMap();
+      void build(Score*);
+      void invalidate()        { _valid = false; }
+      bool valid() const       { return _valid;  }
+      Measure* find(int utick, qreal* x) const;
+      };
+
+#endif
+
@@ -0,0 +1,149 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtCore/QCryptographicHash>
+#include "config.h"
+#include "datacache.h"
+#include "mscore.h"
+
+extern QString revision;
+
+static const quint32 CACHE_MAGIC = 0x4d534443;      // "MSDC"
+
+//---------------------------------------------------------
+//   DataCache
+//    name is the base name of the cache file, version
+//    the format version of the caller's data
+//---------------------------------------------------------
+
+DataCache::DataCache(const QString& name, int version, const QStringList& sources)
+      {
+      _data = 0;
+      if (MScore::cacheDir.isEmpty())
+            return;
+      QCryptographicHash ph(QCryptographicHash::Sha1);
+      QCryptographicHash kh(QCryptographicHash::Sha1);
+      kh.addData(VERSION);
+      kh.addData(revision.toAscii());
+      kh.addData(QByteArray::number(version));
+      foreach(const QString& s, sources) {
+            QFileInfo fi(s);
+            QByteArray path = fi.absoluteFilePath().toUtf8();
+            ph.addData(path);
+            kh.addData(path);
+            kh.addData(QByteArray::number(fi.size()));
+            kh.addData(QByteArray::number(fi.lastModified().toTime_t()));
+            }
+      _key  = kh.result().toHex();
+      _path = QString("%1%2-%3.cache").arg(MScore::cacheDir).arg(name)
+         .arg(QString(ph.result().toHex().left(8)));
+      }
+
+DataCache::~DataCache()
+      {
+      if (_data)
+            _file.unmap(_data);
+      }
+
+//---------------------------------------------------------
+//   read
+//    map the cache file; return a stream positioned after
+//    the header or 0 if there is no valid cache
+//---------------------------------------------------------
+
+QDataStream* DataCache::read()
+      {
+      if (_path.isEmpty())
+            return 0;
+      _file.setFileName(_path);
+      if (!_file.open(QIODevice::ReadOnly))
+            return 0;
+      qint64 size = _file.size();
+      _data = _file.map(0, size);
+      if (_data == 0) {
+            _file.close();
+            return 0;
+            }
+      _buffer.setData(QByteArray::fromRawData((const char*)_data, size));
+      _buffer.open(QIODevice::ReadOnly);
+      _stream.setDevice(&_buffer);
+      _stream.setVersion(QDataStream::Qt_4_6);
+
+      quint32 magic;
+      QByteArray key;
+      _stream >> magic >> key;
+      if (_stream.status() != QDataStream::Ok || magic != CACHE_MAGIC || key != _key) {
+            if (debugMode)
+                  printf("cache <%s> is out of date\n", qPrintable(_path));
+            _stream.setDevice(0);
+            _buffer.close();
+            _file.unmap(_data);
+            _data = 0;
+            _file.close();
+            return 0;
+            }
+      if (debugMode)
+            printf("read cache <%s>\n", qPrintable(_path));
+      return &_stream;
+      }
+
+//---------------------------------------------------------
+//   write
+//    start a new cache file; return 0 if caching is
+//    not possible. The file replaces the old cache on
+//    commit().
+//---------------------------------------------------------
+
+QDataStream* DataCache::write()
+      {
+      if (_path.isEmpty())
+            return 0;
+      if (_data) {
+            _stream.setDevice(0);
+            _buffer.close();
+            _file.unmap(_data);
+            _data = 0;
+            _file.close();
+            }
+      QDir dir;
+      dir.mkpath(MScore::cacheDir);
+      _file.setFileName(_path + ".new");
+      if (!_file.open(QIODevice::WriteOnly))
+            return 0;
+      _stream.setDevice(&_file);
+      _stream.setVersion(QDataStream::Qt_4_6);
+      _stream << CACHE_MAGIC << _key;
+      return &_stream;
+      }
+
+//---------------------------------------------------------
+//   commit
+//---------------------------------------------------------
+
+bool DataCache::commit()
+      {
+      bool ok = _stream.status() == QDataStream::Ok && _file.error() == QFile::NoError;
+      _stream.setDevice(0);
+      _file.close();
+      QString tmp(_path + ".new");
+      if (ok) {
+            QFile::remove(_path);
+            ok = QFile::rename(tmp, _path);
+            }
+      if (!ok) {
+            printf("cannot write cache <%s>\n", qPrintable(_path));
+            QFile::remove(tmp);
+            }
+      return ok;
+      }
+
@@ -0,0 +1,45 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __DATACACHE_H__
+#define __DATACACHE_H__
+
+//---------------------------------------------------------
+//   DataCache
+//    compiled binary copy of xml data files (instrument
+//    templates, chord descriptions) in MScore::cacheDir.
+//    The cache is tagged with path, size and modification
+//    time of all source files and with the program
+//    revision; a changed source silently rebuilds it.
+//    Valid caches are memory mapped and read through a
+//    QDataStream.
+//---------------------------------------------------------
+
+class DataCache {
+      QString _path;
+      QByteArray _key;
+      QFile _file;
+      uchar* _data;
+      QBuffer _buffer;
+      QDataStream _stream;
+
+   public:
+      DataCache(const QString& name, int version, const QStringList& sources);
+      ~DataCache();
+      QDataStream* read();
+      QDataStream* write();
+      bool commit();
+      };
+
+#endif
+
@@ -19,98 +19,138 @@
 //=============================================================================
 
 #include "dsp.h"
-#include "config.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 Dsp* dsp;
 
-#ifdef __i386__
+#if defined(__SSE2__)
 
 //---------------------------------------------------------
-//   DspSSE86
+//   DspSSE2
+//    SSE2 intrinsics, four samples per step; buffers need
+//    no particular alignment. The remaining samples are
+//    handled by the generic routines.
 //---------------------------------------------------------
 
-extern "C" {
-extern float x86_sse_compute_peak(float*, unsigned, float);
-extern void x86_sse_apply_gain_to_buffer(float*, unsigned, float);
-extern void x86_sse_mix_buffers_with_gain(float*, float*, unsigned, float);
-extern void x86_sse_mix_buffers_no_gain(float*, float*, unsigned);
-   };
-
-class DspSSE86 : public Dsp {
+class DspSSE2 : public Dsp {
    public:
-      DspSSE86() {}
-      virtual ~DspSSE86() {}
+      DspSSE2() {}
+      virtual ~DspSSE2() {}
+      virtual const char* name() const { return "SSE2"; }
 
-      virtual float peak(float* buf, unsigned n, float current) {
-            if ( ((intptr_t)buf % 16) != 0) {
-                  fprintf(stderr, "peak(): buffer unaligned! (%p)\n", buf);
-                  return Dsp::peak(buf, n, current);
-                  }
-            return x86_sse_compute_peak(buf, n, current);
+      virtual float peak(const float* buf, unsigned n, float current) {
+            const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            __m128 m = _mm_set1_ps(current);
+            unsigned i = 0;
+            for (; i + 4 <= n; i += 4)
+                  m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(buf + i), mask));
+            m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+            m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+            return Dsp::peak(buf + i, n - i, _mm_cvtss_f32(m));
             }
 
       virtual void applyGainToBuffer(float* buf, unsigned n, float gain) {
-            if ( ((intptr_t)buf % 16) != 0) {
-                  fprintf(stderr, "applyGainToBuffer(): buffer unaligned! (%p)\n", buf);
-                  Dsp::applyGainToBuffer(buf, n, gain);
+            const __m128 g = _mm_set1_ps(gain);
+            unsigned i = 0;
+            for (; i + 4 <= n; i += 4)
+                  _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), g));
+            Dsp::applyGainToBuffer(buf + i, n - i, gain);
+            }
+
+      virtual void mixWithGain(float* dst, const float* src, unsigned n, float gain) {
+            const __m128 g = _mm_set1_ps(gain);
+            unsigned i = 0;
+            for (; i + 4 <= n; i += 4) {
+                  __m128 s = _mm_mul_ps(_mm_loadu_ps(src + i), g);
+                  _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), s));
+                  }
+            Dsp::mixWithGain(dst + i, src + i, n - i, gain);
+            }
+
+      virtual void mix(float* dst, const float* src, unsigned n) {
+            unsigned i = 0;
+            for (; i + 4 <= n; i += 4)
+                  _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+            Dsp::mix(dst + i, src + i, n - i);
+            }
+
+      virtual void interleave(float* dst, const float* l, const float* r, unsigned n) {
+            unsigned i = 0;
+            for (; i + 4 <= n; i += 4) {
+                  __m128 a = _mm_loadu_ps(l + i);
+                  __m128 b = _mm_loadu_ps(r + i);
+                  _mm_storeu_ps(dst + 2 * i,     _mm_unpacklo_ps(a, b));
+                  _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(a, b));
                   }
-            else
-                  x86_sse_apply_gain_to_buffer(buf, n, gain);
+            Dsp::interleave(dst + 2 * i, l + i, r + i, n - i);
             }
 
-      virtual void mixWithGain(float* dst, float* src, unsigned n, float gain) {
-            if ( ((intptr_t)dst & 15) != 0)
-                  fprintf(stderr, "mixWithGainain(): dst unaligned! (%p)\n", dst);
-            if (((intptr_t)dst & 15) != ((intptr_t)src & 15) ) {
-                  fprintf(stderr, "mixWithGain(): dst & src don't have the same alignment!\n");
-                  Dsp::mixWithGain(dst, src,n, gain);
+      virtual void deinterleave(float* l, float* r, const float* src, unsigned n) {
+            unsigned i = 0;
+            for (; i + 4 <= n; i += 4) {
+                  __m128 a = _mm_loadu_ps(src + 2 * i);
+                  __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+                  _mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                  _mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
                   }
-            else
-                  x86_sse_mix_buffers_with_gain(dst, src, n, gain);
+            Dsp::deinterleave(l + i, r + i, src + 2 * i, n - i);
             }
-      virtual void mix(float* dst, float* src, unsigned n) {
-            if ( ((intptr_t)dst & 15) != 0)
-                  fprintf(stderr, "mix_buffers_no_gain(): dst unaligned! %p\n", dst);
-            if ( ((intptr_t)dst & 15) != ((intptr_t)src & 15) ) {
-                  fprintf(stderr, "mix_buffers_no_gain(): dst & src don't have the same alignment!\n");
-                  Dsp::mix(dst, src, n);
+
+      virtual void floatToInt(int* dst, const float* src, unsigned n, int max) {
+            const __m128 hi = _mm_set1_ps(1.0f);
+            const __m128 lo = _mm_set1_ps(-1.0f);
+            const __m128 m  = _mm_set1_ps(float(max));
+            unsigned i = 0;
+            for (; i + 4 <= n; i += 4) {
+                  __m128 s = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi);
+                  _mm_storeu_si128((__m128i*)(dst + i), _mm_cvttps_epi32(_mm_mul_ps(s, m)));
                   }
-            else
-                  x86_sse_mix_buffers_no_gain(dst, src, n);
+            Dsp::floatToInt(dst + i, src + i, n - i, max);
             }
       };
-#endif
 
 //---------------------------------------------------------
-//   initDsp
+//   haveSSE2
 //---------------------------------------------------------
 
-void initDsp()
+static bool haveSSE2()
       {
-#if defined(__i386__) && defined(USE_SSE)
-      unsigned long useSSE = 0;
-
 #ifdef __x86_64__
-      useSSE = 1 << 25;       // we know the platform has SSE
+      return true;            // part of the x86-64 base architecture
 #else
+      unsigned long edx = 0;
       asm (
          "mov $1, %%eax\n"
          "pushl %%ebx\n"
          "cpuid\n"
          "movl %%edx, %0\n"
          "popl %%ebx\n"
-         : "=r" (useSSE)
+         : "=r" (edx)
          :
          : "%eax", "%ecx", "%edx", "memory");
+      return edx & (1 << 26); // bit 26 = SSE2 support
+#endif
+      }
 #endif
-      useSSE &= (1 << 25); // bit 25 = SSE support
-      if (useSSE) {
-            printf("Using SSE optimized routines\n");
-            dsp = new DspSSE86();
+
+//---------------------------------------------------------
+//   initDsp
+//    select the fastest implementation available on
+//    this cpu
+//---------------------------------------------------------
+
+void initDsp()
+      {
+      if (dsp)
+            return;
+#if defined(__SSE2__)
+      if (haveSSE2()) {
+            dsp = new DspSSE2();
             return;
             }
-      // fall through to not hardware optimized routines
 #endif
       dsp = new Dsp();
       }
-
@@ -21,6 +21,9 @@
 #ifndef __DSP_H__
 #define __DSP_H__
 
+#include <math.h>
+#include <string.h>
+
 //---------------------------------------------------------
 //   f_max
 //---------------------------------------------------------
@@ -44,8 +47,9 @@ class Dsp {
    public:
       Dsp() {}
       virtual ~Dsp() {}
+      virtual const char* name() const { return "generic"; }
 
-      virtual float peak(float* buf, unsigned n, float current) {
+      virtual float peak(const float* buf, unsigned n, float current) {
             for (unsigned i = 0; i < n; ++i)
                   current = f_max(current, fabsf(buf[i]));
             return current;
@@ -54,21 +58,41 @@ class Dsp {
             for (unsigned i = 0; i < n; ++i)
                   buf[i] *= gain;
             }
-      virtual void mixWithGain(float* dst, float* src, unsigned n, float gain) {
+      virtual void mixWithGain(float* dst, const float* src, unsigned n, float gain) {
             for (unsigned i = 0; i < n; ++i)
                   dst[i] += src[i] * gain;
             }
-      virtual void mix(float* dst, float* src, unsigned n) {
+      virtual void mix(float* dst, const float* src, unsigned n) {
             for (unsigned i = 0; i < n; ++i)
                   dst[i] += src[i];
             }
-      virtual void cpy(float* dst, float* src, unsigned n) {
-#if defined(ARCH_X86) || defined(ARCH_X86_64)
-            register unsinged long int dummy;
-            __asm__ __volatile__ "rep; movsl" :"=&D"(dst), "=&S"(src), "=&c"(dummy) :"0" (to), "1" (from),"2" (n) : "memory");
-#else
+      virtual void cpy(float* dst, const float* src, unsigned n) {
             memcpy(dst, src, sizeof(float) * n);
-#endif
+            }
+      // dst[2*i] = l[i], dst[2*i+1] = r[i]
+      virtual void interleave(float* dst, const float* l, const float* r, unsigned n) {
+            for (unsigned i = 0; i < n; ++i) {
+                  *dst++ = l[i];
+                  *dst++ = r[i];
+                  }
+            }
+      virtual void deinterleave(float* l, float* r, const float* src, unsigned n) {
+            for (unsigned i = 0; i < n; ++i) {
+                  l[i] = *src++;
+                  r[i] = *src++;
+                  }
+            }
+      // clip to -1.0 - 1.0 and scale to -max - max, truncating
+      virtual void floatToInt(int* dst, const float* src, unsigned n, int max) {
+            for (unsigned i = 0; i < n; ++i) {
+                  float s = src[i];
+                  if (s > 1.0f)
+                        dst[i] = max;
+                  else if (s < -1.0f)
+                        dst[i] = -max;
+                  else
+                        dst[i] = (int)(max * s);
+                  }
             }
       };
 
@@ -0,0 +1,64 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "eventframes.h"
+#include "score.h"
+#include "tempo.h"
+#include "mscore.h"
+
+//---------------------------------------------------------
+//   init
+//    Compute the time of all events from the tempo map
+//    and the repeat list. This is the expensive part and
+//    is done in the gui thread when the events are
+//    collected. Every time is a function of the tick only,
+//    never a sum of block lengths, so there is no drift
+//    however long the score plays.
+//---------------------------------------------------------
+
+void EventFrames::init(const Score* score, const QList<int>& ticks)
+      {
+      _relTempo = score->tempomap()->relTempo();
+      _ticks    = ticks.toVector();
+      _times.resize(_ticks.size());
+      for (int i = 0; i < _ticks.size(); ++i) {
+            if (i > 0 && _ticks[i] == _ticks[i-1])
+                  _times[i] = _times[i-1];
+            else
+                  _times[i] = score->utick2utime(_ticks[i]) * _relTempo;
+            }
+      }
+
+//---------------------------------------------------------
+//   index
+//    return index of first event with tick >= utick; this
+//    is the position of EventMap::lowerBound(utick)
+//---------------------------------------------------------
+
+int EventFrames::index(int utick) const
+      {
+      return qLowerBound(_ticks.begin(), _ticks.end(), utick) - _ticks.begin();
+      }
+
+//---------------------------------------------------------
+//   frame
+//    called in the audio thread; all times scale with the
+//    relative tempo, so a tempo change only needs
+//    setRelTempo()
+//---------------------------------------------------------
+
+qint64 EventFrames::frame(int idx) const
+      {
+      return qRound64(_times[idx] / _relTempo * MScore::sampleRate);
+      }
+
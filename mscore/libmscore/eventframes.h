@@ -0,0 +1,44 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __EVENTFRAMES_H__
+#define __EVENTFRAMES_H__
+
+class Score;
+
+//---------------------------------------------------------
+//   EventFrames
+//    audio frame position of every event of an event map,
+//    in map order; the sequencers index this in parallel
+//    to their map iterator instead of converting every
+//    event tick in the audio thread.
+//    It only needs the event ticks, so it works for the
+//    EventMap of libmscore and of the player alike.
+//---------------------------------------------------------
+
+class EventFrames {
+      QVector<int> _ticks;          // utick of every event
+      QVector<qreal> _times;        // time of every event at relative tempo 1.0
+      qreal _relTempo;
+
+   public:
+      EventFrames()                 { _relTempo = 1.0; }
+      void init(const Score*, const QList<int>& ticks);
+      void setRelTempo(qreal val)   { _relTempo = val; }
+      int index(int utick) const;
+      qint64 frame(int idx) const;
+      int size() const              { return _ticks.size(); }
+      };
+
+#endif
+
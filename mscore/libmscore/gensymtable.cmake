@@ -0,0 +1,64 @@
+#=============================================================================
+#  MuseScore
+#  Music Composition & Notation
+#  $Id:$
+#
+#  Copyright (C) 2011 Werner Schweer
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License version 2
+#  as published by the Free Software Foundation and appearing in
+#  the file LICENSE.GPL
+#=============================================================================
+
+#
+#  generate symtable.h with the glyph metrics of the music
+#  fonts from fonts/mscore20.xml and fonts/gonville.xml
+#
+#  cmake -DFONTS=<fonts dir> -DOUT=<symtable.h> -P gensymtable.cmake
+#
+
+macro (gen_table TABLE XMLFILE FONTFILE)
+      file (READ ${FONTS}/${FONTFILE} FONTDATA HEX)
+      string (LENGTH "${FONTDATA}" FONTSIZE)
+      math (EXPR FONTSIZE "${FONTSIZE} / 2")
+      file (STRINGS ${FONTS}/${XMLFILE} LINES)
+      set (N 0)
+      file (APPEND ${OUT} "static const SymTableEntry ${TABLE}[] = {\n")
+      foreach (LINE ${LINES})
+            if (LINE MATCHES "<name>(.*)</name>")
+                  set (NAME ${CMAKE_MATCH_1})
+            elseif (LINE MATCHES "<code>(.*)</code>")
+                  set (CODE ${CMAKE_MATCH_1})
+            elseif (LINE MATCHES "<attach x=\"([^\"]*)\" y=\"([^\"]*)\"")
+                  set (ATTACH "${CMAKE_MATCH_1}, ${CMAKE_MATCH_2}")
+            elseif (LINE MATCHES "<bbox x=\"([^\"]*)\" y=\"([^\"]*)\" w=\"([^\"]*)\" h=\"([^\"]*)\"")
+                  set (BBOX "${CMAKE_MATCH_1}, ${CMAKE_MATCH_2}, ${CMAKE_MATCH_3}, ${CMAKE_MATCH_4}")
+            elseif (LINE MATCHES "</Glyph>")
+                  file (APPEND ${OUT} "      { \"${NAME}\", ${CODE}, ${ATTACH}, ${BBOX} },\n")
+                  math (EXPR N "${N} + 1")
+                  set (ATTACH "0, 0")
+                  set (BBOX "0, 0, 0, 0")
+            endif ()
+      endforeach (LINE)
+      file (APPEND ${OUT} "      };\n")
+      file (APPEND ${OUT} "static const int ${TABLE}Size = ${N};\n")
+      file (APPEND ${OUT} "static const qint64 ${TABLE}FontSize = ${FONTSIZE};   // size of ${FONTFILE}\n\n")
+endmacro (gen_table)
+
+file (WRITE ${OUT}
+   "// generated by libmscore/gensymtable.cmake; do not edit\n\n"
+   "#ifndef __SYMTABLE_H__\n"
+   "#define __SYMTABLE_H__\n\n"
+   "struct SymTableEntry {\n"
+   "      const char* name;\n"
+   "      int code;\n"
+   "      qreal ax, ay;                 // attach point\n"
+   "      qreal bx, by, bw, bh;         // bounding box\n"
+   "      };\n\n"
+   )
+set (ATTACH "0, 0")
+set (BBOX "0, 0, 0, 0")
+gen_table (mscore20Table mscore20.xml mscore-20.otf)
+gen_table (gonvilleTable gonville.xml gonville-20.otf)
+file (APPEND ${OUT} "#endif\n")
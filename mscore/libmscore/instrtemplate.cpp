@@ -21,10 +21,14 @@
 #include "utils.h"
 #include "tablature.h"
 #include "mscore.h"
+#include "datacache.h"
 
 QList<InstrumentGroup*> instrumentGroups;
 QList<MidiArticulation*> articulation;                // global articulations
 
+static QHash<QString, InstrumentTemplate*> templateIndex;   // track name -> first template
+static const int TEMPLATE_CACHE_VERSION = 1;              // bump on format change
+
 //---------------------------------------------------------
 //   InstrumentTemplate
 //---------------------------------------------------------
@@ -418,6 +422,8 @@ static void readInstrumentGroup(InstrumentGroup* group, QDomElement e)
                   InstrumentTemplate* t = new InstrumentTemplate;
                   group->instrumentTemplates.append(t);
                   t->read(e);
+                  if (!templateIndex.contains(t->trackName))
+                        templateIndex.insert(t->trackName, t);
                   }
             else if (tag == "ref") {
                   InstrumentTemplate* ttt = searchTemplate(e.text());
@@ -433,8 +439,330 @@ static void readInstrumentGroup(InstrumentGroup* group, QDomElement e)
             }
       }
 
+//---------------------------------------------------------
+//   writeEvents
+//    template event lists only hold controller events
+//---------------------------------------------------------
+
+static void writeEvents(QDataStream& s, const EventList& el, int from = 0)
+      {
+      s << qint32(el.size() - from);
+      for (int i = from; i < el.size(); ++i) {
+            const Event& e = el[i];
+            s << qint32(e.type()) << qint32(e.controller()) << qint32(e.value());
+            }
+      }
+
+static void readEvents(QDataStream& s, EventList* el)
+      {
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            qint32 type, ctrl, value;
+            s >> type >> ctrl >> value;
+            Event e(type);
+            e.setController(ctrl);
+            e.setValue(value);
+            el->append(e);
+            }
+      }
+
+//---------------------------------------------------------
+//   writeArticulation
+//---------------------------------------------------------
+
+static void writeArticulation(QDataStream& s, const MidiArticulation& a)
+      {
+      s << a.name << a.descr << qint32(a.velocity) << qint32(a.gateTime);
+      }
+
+static void readArticulation(QDataStream& s, MidiArticulation* a)
+      {
+      qint32 velocity, gateTime;
+      s >> a->name >> a->descr >> velocity >> gateTime;
+      a->velocity = velocity;
+      a->gateTime = gateTime;
+      }
+
+//---------------------------------------------------------
+//   writeMidiActions
+//---------------------------------------------------------
+
+static void writeMidiActions(QDataStream& s, const QList<NamedEventList>& l)
+      {
+      s << qint32(l.size());
+      foreach(const NamedEventList& a, l) {
+            s << a.name << a.descr;
+            writeEvents(s, a.events);
+            }
+      }
+
+static void readMidiActions(QDataStream& s, QList<NamedEventList>* l)
+      {
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            NamedEventList a;
+            s >> a.name >> a.descr;
+            readEvents(s, &a.events);
+            l->append(a);
+            }
+      }
+
+//---------------------------------------------------------
+//   writeChannel
+//    the first A_INIT_COUNT init events are rebuilt from
+//    the channel values by updateInitList()
+//---------------------------------------------------------
+
+static void writeChannel(QDataStream& s, const Channel& c)
+      {
+      s << c.name << c.descr << qint32(c.channel) << qint32(c.synti)
+        << qint32(c.program) << qint32(c.bank)
+        << qint8(c.volume) << qint8(c.pan) << qint8(c.chorus) << qint8(c.reverb)
+        << c.mute << c.solo << c.soloMute;
+      writeEvents(s, c.init, A_INIT_COUNT);
+      writeMidiActions(s, c.midiActions);
+      s << qint32(c.articulation.size());
+      foreach(const MidiArticulation& a, c.articulation)
+            writeArticulation(s, a);
+      }
+
+static void readChannel(QDataStream& s, Channel* c)
+      {
+      qint32 channel, synti, program, bank;
+      qint8 volume, pan, chorus, reverb;
+      s >> c->name >> c->descr >> channel >> synti >> program >> bank
+        >> volume >> pan >> chorus >> reverb
+        >> c->mute >> c->solo >> c->soloMute;
+      c->channel = channel;
+      c->synti   = synti;
+      c->program = program;
+      c->bank    = bank;
+      c->volume  = volume;
+      c->pan     = pan;
+      c->chorus  = chorus;
+      c->reverb  = reverb;
+      readEvents(s, &c->init);
+      readMidiActions(s, &c->midiActions);
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            MidiArticulation a;
+            readArticulation(s, &a);
+            c->articulation.append(a);
+            }
+      c->updateInitList();
+      }
+
+//---------------------------------------------------------
+//   writeStaffNames
+//---------------------------------------------------------
+
+static void writeStaffNames(QDataStream& s, const QList<StaffName>& l)
+      {
+      s << qint32(l.size());
+      foreach(const StaffName& sn, l)
+            s << sn.name << qint32(sn.pos);
+      }
+
+static void readStaffNames(QDataStream& s, QList<StaffName>* l)
+      {
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            QString name;
+            qint32 pos;
+            s >> name >> pos;
+            l->append(StaffName(name, pos));
+            }
+      }
+
+//---------------------------------------------------------
+//   writeCache
+//---------------------------------------------------------
+
+void InstrumentTemplate::writeCache(QDataStream& s) const
+      {
+      s << trackName;
+      writeStaffNames(s, longNames);
+      writeStaffNames(s, shortNames);
+      s << qint8(minPitchA) << qint8(maxPitchA) << qint8(minPitchP) << qint8(maxPitchP)
+        << qint8(transpose.diatonic) << qint8(transpose.chromatic);
+      s << useDrumset << bool(drumset);
+      if (drumset) {
+            for (int i = 0; i < DRUM_INSTRUMENTS; ++i) {
+                  const DrumInstrument& d = drumset->drum(i);
+                  s << d.name << qint32(d.notehead) << qint32(d.line)
+                    << qint32(d.stemDirection) << qint32(d.voice) << qint8(d.shortcut);
+                  }
+            }
+      writeMidiActions(s, midiActions);
+      s << qint32(articulation.size());
+      foreach(const MidiArticulation& a, articulation)
+            writeArticulation(s, a);
+      s << qint32(channel.size());
+      foreach(const Channel& c, channel)
+            writeChannel(s, c);
+      s << qint32(staves);
+      for (int i = 0; i < MAX_STAVES; ++i) {
+            s << qint32(clefIdx[i]) << qint32(staffLines[i]) << qint32(bracket[i])
+              << qint32(bracketSpan[i]) << qint32(barlineSpan[i]) << smallStaff[i];
+            }
+      s << useTablature << bool(tablature);
+      if (tablature) {
+            s << qint32(tablature->frets()) << qint32(tablature->strings());
+            foreach(int pitch, tablature->stringList())
+                  s << qint32(pitch);
+            }
+      s << extended;
+      }
+
+//---------------------------------------------------------
+//   readCache
+//---------------------------------------------------------
+
+void InstrumentTemplate::readCache(QDataStream& s)
+      {
+      s >> trackName;
+      readStaffNames(s, &longNames);
+      readStaffNames(s, &shortNames);
+      qint8 minA, maxA, minP, maxP, diatonic, chromatic;
+      s >> minA >> maxA >> minP >> maxP >> diatonic >> chromatic;
+      minPitchA           = minA;
+      maxPitchA           = maxA;
+      minPitchP           = minP;
+      maxPitchP           = maxP;
+      transpose.diatonic  = diatonic;
+      transpose.chromatic = chromatic;
+
+      bool hasDrumset;
+      s >> useDrumset >> hasDrumset;
+      if (hasDrumset) {
+            drumset = new Drumset;
+            for (int i = 0; i < DRUM_INSTRUMENTS; ++i) {
+                  DrumInstrument& d = drumset->drum(i);
+                  qint32 notehead, line, stemDirection, voice;
+                  qint8 shortcut;
+                  s >> d.name >> notehead >> line >> stemDirection >> voice >> shortcut;
+                  d.notehead      = notehead;
+                  d.line          = line;
+                  d.stemDirection = Direction(stemDirection);
+                  d.voice         = voice;
+                  d.shortcut      = shortcut;
+                  }
+            }
+      readMidiActions(s, &midiActions);
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            MidiArticulation a;
+            readArticulation(s, &a);
+            articulation.append(a);
+            }
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            Channel c;
+            readChannel(s, &c);
+            channel.append(c);
+            }
+      qint32 nstaves;
+      s >> nstaves;
+      staves = nstaves;
+      for (int i = 0; i < MAX_STAVES; ++i) {
+            qint32 clef, lines, br, brSpan, blSpan;
+            s >> clef >> lines >> br >> brSpan >> blSpan >> smallStaff[i];
+            clefIdx[i]     = ClefType(clef);
+            staffLines[i]  = lines;
+            bracket[i]     = br;
+            bracketSpan[i] = brSpan;
+            barlineSpan[i] = blSpan;
+            }
+      bool hasTablature;
+      s >> useTablature >> hasTablature;
+      if (hasTablature) {
+            qint32 frets, strings;
+            s >> frets >> strings;
+            QList<int> sl;
+            for (int i = 0; i < strings && s.status() == QDataStream::Ok; ++i) {
+                  qint32 pitch;
+                  s >> pitch;
+                  sl.append(pitch);
+                  }
+            tablature = new Tablature(frets, sl);
+            }
+      s >> extended;
+      }
+
+//---------------------------------------------------------
+//   clearInstrumentTemplates
+//---------------------------------------------------------
+
+static void clearInstrumentTemplates()
+      {
+      foreach(InstrumentGroup* g, instrumentGroups) {
+            foreach(InstrumentTemplate* t, g->instrumentTemplates)
+                  delete t;
+            delete g;
+            }
+      instrumentGroups.clear();
+      templateIndex.clear();
+      qDeleteAll(articulation);
+      articulation.clear();
+      }
+
+//---------------------------------------------------------
+//   writeTemplateCache
+//---------------------------------------------------------
+
+static void writeTemplateCache(QDataStream& s)
+      {
+      s << qint32(articulation.size());
+      foreach(const MidiArticulation* a, articulation)
+            writeArticulation(s, *a);
+      s << qint32(instrumentGroups.size());
+      foreach(const InstrumentGroup* g, instrumentGroups) {
+            s << g->name << g->extended << qint32(g->instrumentTemplates.size());
+            foreach(const InstrumentTemplate* t, g->instrumentTemplates)
+                  t->writeCache(s);
+            }
+      }
+
+//---------------------------------------------------------
+//   readTemplateCache
+//    return false if the cache is damaged
+//---------------------------------------------------------
+
+static bool readTemplateCache(QDataStream& s)
+      {
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            MidiArticulation* a = new MidiArticulation;
+            readArticulation(s, a);
+            articulation.append(a);
+            }
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            InstrumentGroup* group = new InstrumentGroup;
+            instrumentGroups.append(group);
+            qint32 nt;
+            s >> group->name >> group->extended >> nt;
+            for (int k = 0; k < nt && s.status() == QDataStream::Ok; ++k) {
+                  InstrumentTemplate* t = new InstrumentTemplate;
+                  group->instrumentTemplates.append(t);
+                  t->readCache(s);
+                  if (!templateIndex.contains(t->trackName))
+                        templateIndex.insert(t->trackName, t);
+                  }
+            }
+      return s.status() == QDataStream::Ok;
+      }
+
 //---------------------------------------------------------
 //   loadInstrumentTemplates
+//    the parsed templates are kept in a binary cache
+//    which is used as long as the xml file is unchanged
 //---------------------------------------------------------
 
 bool loadInstrumentTemplates(const QString& instrTemplates)
@@ -443,6 +771,17 @@ bool loadInstrumentTemplates(const QString& instrTemplates)
       if (!qf.open(QIODevice::ReadOnly))
             return false;
 
+      clearInstrumentTemplates();
+
+      DataCache cache("instruments", TEMPLATE_CACHE_VERSION, QStringList(instrTemplates));
+      QDataStream* cs = cache.read();
+      if (cs) {
+            if (readTemplateCache(*cs))
+                  return true;
+            printf("damaged instrument template cache\n");
+            clearInstrumentTemplates();
+            }
+
       QDomDocument doc;
       int line, column;
       QString err;
@@ -452,13 +791,6 @@ bool loadInstrumentTemplates(const QString& instrTemplates)
       docName = qf.fileName();
       qf.close();
 
-      foreach(InstrumentGroup* g, instrumentGroups) {
-            foreach(InstrumentTemplate* t, g->instrumentTemplates)
-                  delete t;
-            delete g;
-            }
-      instrumentGroups.clear();
-
       if (!rv) {
             QString s;
             s.sprintf("error reading file %s at line %d column %d: %s\n",
@@ -490,6 +822,11 @@ bool loadInstrumentTemplates(const QString& instrTemplates)
                         }
                   }
             }
+      cs = cache.write();
+      if (cs) {
+            writeTemplateCache(*cs);
+            cache.commit();
+            }
       return true;
       }
 
@@ -499,35 +836,35 @@ bool loadInstrumentTemplates(const QString& instrTemplates)
 
 InstrumentTemplate* searchTemplate(const QString& name)
       {
-      foreach(InstrumentGroup* g, instrumentGroups) {
-            foreach(InstrumentTemplate* it, g->instrumentTemplates) {
-// printf("<%s><%s>\n", qPrintable(name), qPrintable(it->trackName));
-                  if (it->trackName == name)
-                        return it;
-                  }
-            }
-      return 0;
+      return templateIndex.value(name);
       }
 
 //---------------------------------------------------------
 //   populateInstrumentList
+//    only the group items are created here; the
+//    instrument items of a group are added by
+//    populateInstrumentGroup() when it is expanded
 //---------------------------------------------------------
 
 void populateInstrumentList(QTreeWidget* instrumentList, bool extended)
       {
       instrumentList->clear();
-      // TODO: memory leak
       foreach(InstrumentGroup* g, instrumentGroups) {
             if (!extended && g->extended)
                   continue;
-            InstrumentTemplateListItem* group = new InstrumentTemplateListItem(g->name, instrumentList);
+            InstrumentTemplateListItem* group = new InstrumentTemplateListItem(g, extended, instrumentList);
             group->setFlags(Qt::ItemIsEnabled);
-            foreach(InstrumentTemplate* t, g->instrumentTemplates) {
-                  if (!extended && t->extended)
-                        continue;
-                  new InstrumentTemplateListItem(t, group);
-                  }
             }
       }
 
+//---------------------------------------------------------
+//   populateInstrumentGroup
+//    called when item is expanded in an instrument list
+//---------------------------------------------------------
+
+void populateInstrumentGroup(QTreeWidgetItem* item)
+      {
+      static_cast<InstrumentTemplateListItem*>(item)->populate();
+      }
+
 
@@ -65,6 +65,8 @@ struct InstrumentTemplate {
       void setPitchRange(const QString& s, char* a, char* b) const;
       void write(Xml& xml) const;
       void read(QDomElement);
+      void writeCache(QDataStream&) const;
+      void readCache(QDataStream&);
       };
 
 //---------------------------------------------------------
@@ -84,14 +86,17 @@ struct InstrumentGroup {
 class InstrumentTemplateListItem : public QTreeWidgetItem {
       InstrumentTemplate* _instrumentTemplate;
       QString _group;
+      InstrumentGroup* _instrumentGroup;  ///< set until the children are created
+      bool _extended;
 
    public:
-      InstrumentTemplateListItem(QString group, QTreeWidget* parent);
+      InstrumentTemplateListItem(InstrumentGroup* g, bool extended, QTreeWidget* parent);
       InstrumentTemplateListItem(InstrumentTemplate* i, InstrumentTemplateListItem* parent);
       InstrumentTemplateListItem(InstrumentTemplate* i, QTreeWidget* parent);
 
       InstrumentTemplate* instrumentTemplate() const { return _instrumentTemplate; }
       virtual QString text(int col) const;
+      void populate();
       };
 
 enum { ITEM_KEEP, ITEM_DELETE, ITEM_ADD };
@@ -144,5 +149,6 @@ extern QList<MidiArticulation*> articulation;
 extern bool loadInstrumentTemplates(const QString& instrTemplates);
 extern InstrumentTemplate* searchTemplate(const QString& name);
 extern void populateInstrumentList(QTreeWidget* instrumentList, bool extended);
+extern void populateInstrumentGroup(QTreeWidgetItem*);
 #endif
 
@@ -597,6 +597,9 @@ void Score::doLayout()
       {
       QWriteLocker locker(&_layoutLock);
 
+      _layoutPending = false;
+      _spacingHits   = 0;
+      _spacingMisses = 0;
       _symIdx = 0;
       if (_style.valueSt(ST_MusicalSymbolFont) == "Gonville")
             _symIdx = 1;
@@ -713,6 +716,14 @@ void Score::doLayout()
             }
 
       rebuildBspTree();
+      _cursorMap.invalidate();
+      _layoutCache.clear();         // only the first layout after loading can use it
+
+      if (debugMode) {
+            int n = _spacingHits + _spacingMisses;
+            printf("doLayout: measure spacing memo %d hits %d misses (%.1f%%)\n",
+               _spacingHits, _spacingMisses, n ? _spacingHits * 100.0 / n : 0.0);
+            }
 
       }     // unlock mutex
       foreach(MuseScoreView* v, viewer)
@@ -912,8 +923,12 @@ bool Score::layoutSystem(qreal& minWidth, qreal w, bool isFirstSystem, bool long
       bool isFirstMeasure   = true;
       Measure* firstMeasure = 0;
       Measure* lastMeasure  = 0;
+      int cachedMeasures    = _layoutCache.measures(curSystem);
 
       for (; curMeasure;) {
+            // the layout cache knows where the system ends
+            if (cachedMeasures >= 0 && system->measures().size() >= cachedMeasures)
+                  break;
             MeasureBase* nextMeasure;
             if (curMeasure->type() == MEASURE) {
                   Measure* m = static_cast<Measure*>(curMeasure);
@@ -952,18 +967,22 @@ bool Score::layoutSystem(qreal& minWidth, qreal w, bool isFirstSystem, bool long
 
                   m->createEndBarLines();
 
-                  m->layoutX(1.0);
-                  ww      = m->layoutWidth().stretchable;
-                  stretch = m->userStretch() * styleD(ST_measureSpacing);
+                  if (cachedMeasures >= 0)
+                        ww = _layoutCache.width(curSystem, system->measures().size());
+                  else {
+                        m->layoutX(1.0);
+                        ww      = m->layoutWidth().stretchable;
+                        stretch = m->userStretch() * styleD(ST_measureSpacing);
 
-                  ww *= stretch;
-                  if (ww < point(styleS(ST_minMeasureWidth)))
-                        ww = point(styleS(ST_minMeasureWidth));
+                        ww *= stretch;
+                        if (ww < point(styleS(ST_minMeasureWidth)))
+                              ww = point(styleS(ST_minMeasureWidth));
+                        }
                   isFirstMeasure = false;
                   }
 
             // collect at least one measure
-            if ((minWidth + ww > systemWidth) && !system->measures().isEmpty()) {
+            if (cachedMeasures < 0 && (minWidth + ww > systemWidth) && !system->measures().isEmpty()) {
                   curMeasure->setSystem(oldSystem);
                   break;
                   }
@@ -1286,7 +1305,8 @@ bool Score::doReLayout()
                   static_cast<Measure*>(mb)->layout2();
             }
 
-      rebuildBspTree();
+      system->page()->rebuildBspTree();     // other pages did not change
+      _cursorMap.invalidate();
       return true;
       }
 
@@ -1603,6 +1623,13 @@ QList<System*> Score::layoutSystemRow(qreal rowWidth, bool isFirstSystem, bool u
                   }
             }
 
+      //
+      // systems taken from the layout cache keep their
+      // saved measure widths
+      //
+      int cachedSystem = curSystem - sl.size();
+      bool cached      = _layoutCache.measures(cachedSystem) >= 0;
+
       minWidth           = 0.0;
       qreal totalWeight = 0.0;
 
@@ -1613,8 +1640,14 @@ QList<System*> Score::layoutSystemRow(qreal rowWidth, bool isFirstSystem, bool u
                         }
                   else if (mb->type() == MEASURE) {
                         Measure* m = (Measure*)mb;
-                        if (needRelayout)
+                        if (cached)
+                              continue;
+                        if (needRelayout) {
+                              // courtesy signatures or bar lines changed
+                              // segments after layoutX() was memoized
+                              m->setDirty();
                               m->layoutX(1.0);
+                              }
                         minWidth    += m->layoutWidth().stretchable;
                         totalWeight += m->ticks() * m->userStretch();
                         }
@@ -1622,7 +1655,7 @@ QList<System*> Score::layoutSystemRow(qreal rowWidth, bool isFirstSystem, bool u
             minWidth += system->leftMargin();
             }
 
-      qreal rest = (raggedRight ? 0.0 : rowWidth - minWidth) / totalWeight;
+      qreal rest = cached ? 0.0 : (raggedRight ? 0.0 : rowWidth - minWidth) / totalWeight;
       qreal xx   = 0.0;
       qreal y    = 0.0;
 
@@ -1630,6 +1663,7 @@ QList<System*> Score::layoutSystemRow(qreal rowWidth, bool isFirstSystem, bool u
             QPointF pos;
 
             bool firstMeasure = true;
+            int idx = 0;
             foreach(MeasureBase* mb, system->measures()) {
                   qreal ww = 0.0;
                   if (mb->type() == MEASURE) {
@@ -1639,7 +1673,14 @@ QList<System*> Score::layoutSystemRow(qreal rowWidth, bool isFirstSystem, bool u
                               }
                         mb->setPos(pos);
                         Measure* m    = static_cast<Measure*>(mb);
-                        if (styleB(ST_FixMeasureWidth)) {
+                        if (cached) {
+                              ww = _layoutCache.width(cachedSystem, idx);
+                              if (ww < 0.0) {   // not in the cache, use the natural width
+                                    m->layoutX(1.0);
+                                    ww = m->layoutWidth().stretchable;
+                                    }
+                              }
+                        else if (styleB(ST_FixMeasureWidth)) {
                               ww = rowWidth / system->measures().size();
                               }
                         else {
@@ -1654,8 +1695,10 @@ QList<System*> Score::layoutSystemRow(qreal rowWidth, bool isFirstSystem, bool u
                         mb->layout();
                         }
                   pos.rx() += ww;
+                  ++idx;
                   }
             system->setPos(xx, y);
+            ++cachedSystem;
             qreal w = pos.x();
             system->setWidth(w);
             system->layout2();
@@ -1965,6 +2008,7 @@ void Score::doLayoutPages()
             QWriteLocker locker(&_layoutLock);
             layoutPages();
             rebuildBspTree();
+            _cursorMap.invalidate();
             _updateAll = true;
             }
 
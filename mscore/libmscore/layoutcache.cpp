@@ -0,0 +1,174 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtCore/QCryptographicHash>
+#include "config.h"
+#include "layoutcache.h"
+#include "score.h"
+#include "system.h"
+#include "measurebase.h"
+#include "xml.h"
+#include "mscore.h"
+#include "style.h"
+
+extern QString revision;
+
+//---------------------------------------------------------
+//   LayoutCache
+//---------------------------------------------------------
+
+LayoutCache::LayoutCache()
+      {
+      _valid = false;
+      }
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void LayoutCache::clear()
+      {
+      _key.clear();
+      _systems.clear();
+      _valid = false;
+      }
+
+//---------------------------------------------------------
+//   build
+//    record the current layout of score
+//---------------------------------------------------------
+
+void LayoutCache::build(Score* score)
+      {
+      _systems.clear();
+      foreach(System* system, *score->systems()) {
+            QList<qreal> wl;
+            foreach(MeasureBase* mb, system->measures())
+                  wl.append(mb->width());
+            _systems.append(wl);
+            }
+      _valid = !_systems.isEmpty();
+      }
+
+//---------------------------------------------------------
+//   measures
+//    number of measure bases in system; -1 if the cache
+//    does not know the system
+//---------------------------------------------------------
+
+int LayoutCache::measures(int system) const
+      {
+      if (!_valid || system >= _systems.size())
+            return -1;
+      return _systems[system].size();
+      }
+
+//---------------------------------------------------------
+//   width
+//    width of measure base idx of system; -1 if the
+//    cache does not know it
+//---------------------------------------------------------
+
+qreal LayoutCache::width(int system, int idx) const
+      {
+      if (!_valid || system < 0 || system >= _systems.size())
+            return -1.0;
+      const QList<qreal>& wl = _systems[system];
+      if (idx < 0 || idx >= wl.size())
+            return -1.0;
+      return wl[idx];
+      }
+
+//---------------------------------------------------------
+//   write
+//---------------------------------------------------------
+
+void LayoutCache::write(Xml& xml) const
+      {
+      xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+      xml.stag(QString("layoutCache key=\"%1\"").arg(QString(_key)));
+      foreach(const QList<qreal>& wl, _systems) {
+            QString s;
+            foreach(qreal w, wl) {
+                  if (!s.isEmpty())
+                        s += QChar(' ');
+                  s += QString::number(w, 'g', 12);
+                  }
+            xml.tag("system", s);
+            }
+      xml.etag();
+      }
+
+//---------------------------------------------------------
+//   read
+//    return true if data is a cache for key
+//---------------------------------------------------------
+
+bool LayoutCache::read(const QByteArray& data, const QByteArray& key)
+      {
+      clear();
+      QDomDocument doc;
+      if (!doc.setContent(data, false))
+            return false;
+      QDomElement e = doc.documentElement();
+      if (e.tagName() != "layoutCache" || e.attribute("key").toAscii() != key)
+            return false;
+      for (QDomElement ee = e.firstChildElement(); !ee.isNull(); ee = ee.nextSiblingElement()) {
+            if (ee.tagName() != "system") {
+                  domError(ee);
+                  continue;
+                  }
+            QList<qreal> wl;
+            foreach(const QString& s, ee.text().split(' ', QString::SkipEmptyParts))
+                  wl.append(s.toDouble());
+            if (wl.isEmpty()) {
+                  _systems.clear();
+                  return false;
+                  }
+            _systems.append(wl);
+            }
+      _key   = key;
+      _valid = !_systems.isEmpty();
+      return _valid;
+      }
+
+//---------------------------------------------------------
+//   computeKey
+//    scoreHash is the sha1 hash of the score file; the
+//    file holds style and page format, the program version
+//    stands for layout code and symbol font metrics.
+//    Text widths depend on the installed fonts, so the
+//    resolved family and the extent of a sample string
+//    of every text style are hashed too.
+//---------------------------------------------------------
+
+QByteArray LayoutCache::computeKey(const Score* score, const QByteArray& scoreHash)
+      {
+      QCryptographicHash h(QCryptographicHash::Sha1);
+      h.addData(scoreHash);
+      h.addData(VERSION);
+      h.addData(revision.toAscii());
+      h.addData(QByteArray::number(DPI, 'g', 12));
+
+      static const QString sample("Allegro 1234567890 mf");
+      qreal sp = score->spatium();
+      for (int i = 0; i < TEXT_STYLES; ++i) {
+            const TextStyle& ts = score->textStyle(TextStyleType(i));
+            h.addData(QFontInfo(ts.fontPx(sp)).family().toUtf8());
+            QRectF r = ts.bbox(sp, sample);
+            h.addData(QByteArray::number(r.width(), 'g', 12));
+            h.addData(QByteArray::number(r.height(), 'g', 12));
+            }
+      return h.result().toHex();
+      }
+
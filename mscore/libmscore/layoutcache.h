@@ -0,0 +1,53 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __LAYOUTCACHE_H__
+#define __LAYOUTCACHE_H__
+
+class Score;
+class Xml;
+
+//---------------------------------------------------------
+//   LayoutCache
+//    system breaks and final measure widths of a laid out
+//    score; saved as an extra entry in .mscz files.
+//    The key is a hash of the score file content and of
+//    everything outside the file the layout depends on.
+//    A valid cache lets the first layout after loading
+//    skip the minimum width pass and the line breaking.
+//---------------------------------------------------------
+
+class LayoutCache {
+      QByteArray _key;
+      QList<QList<qreal> > _systems;      ///< width of every measure base of every system
+      bool _valid;
+
+   public:
+      LayoutCache();
+      void build(Score*);
+      void clear();
+      bool valid() const                        { return _valid; }
+      const QByteArray& key() const             { return _key; }
+      void setKey(const QByteArray& k)          { _key = k; }
+
+      int measures(int system) const;
+      qreal width(int system, int idx) const;
+
+      void write(Xml&) const;
+      bool read(const QByteArray& data, const QByteArray& key);
+
+      static QByteArray computeKey(const Score*, const QByteArray& scoreHash);
+      };
+
+#endif
+
@@ -18,6 +18,7 @@
 #include "score.h"
 #include "xml.h"
 #include "system.h"
+#include "page.h"
 #include "utils.h"
 
 //---------------------------------------------------------
@@ -270,8 +271,15 @@ bool LineSegment::edit(MuseScoreView* sv, int curGrip, int key, Qt::KeyboardModi
 
             if (nls && (nls != this))
                   sv->changeEditElement(nls);
-      if (bspDirty)
-            _score->rebuildBspTree();
+      if (bspDirty) {
+            // only the pages holding segments of this line changed
+            foreach(SpannerSegment* ss, l->spannerSegments()) {
+                  if (ss->system())
+                        ss->system()->page()->rebuildBspTree();
+                  }
+            if (ls && ls->system())
+                  ls->system()->page()->rebuildBspTree();
+            }
       if (ls)
             _score->undoRemoveElement(ls);
       return true;
@@ -837,7 +837,7 @@ Segment* Measure::getSegment(SegmentType st, int t, int gl)
 
 void Measure::add(Element* el)
       {
-      _dirty = true;
+      setDirty();
 
       el->setParent(this);
       ElementType type = el->type();
@@ -984,7 +984,7 @@ void Measure::add(Element* el)
 
 void Measure::remove(Element* el)
       {
-      _dirty = true;
+      setDirty();
 
       switch(el->type()) {
             case SPACER:
@@ -2422,6 +2422,8 @@ bool Measure::setStartRepeatBarLine(bool val)
                         }
                   }
             }
+      if (changed)
+            setDirty();       // the spacing memo of layoutX() is stale
       return changed;
       }
 
@@ -2497,6 +2499,8 @@ bool Measure::createEndBarLines()
             staffIdx += (span ? span : 1);
             }
 
+      if (changed)
+            setDirty();       // the spacing memo of layoutX() is stale
       return changed;
       }
 
@@ -2718,61 +2722,44 @@ void Space::max(const Space& s)
             _rw = s._rw;
       }
 
-//---------------------------------------------------------
-//   Spring
-//---------------------------------------------------------
-
-struct Spring {
-      int seg;
-      qreal stretch;
-      qreal fix;
-      Spring(int i, qreal s, qreal f) : seg(i), stretch(s), fix(f) {}
-      };
-
-typedef std::multimap<qreal, Spring, std::less<qreal> > SpringMap;
-typedef SpringMap::iterator iSpring;
-
 //---------------------------------------------------------
 //   sff
 //    compute 1/Force for a given Extend
+//    springs are sorted by force
 //---------------------------------------------------------
 
-static qreal sff(qreal x, qreal xMin, SpringMap& springs)
+static qreal sff(qreal x, qreal xMin, const QVector<Spring>& springs)
       {
       if (x <= xMin)
             return 0.0;
-      iSpring i = springs.begin();
-      qreal c  = i->second.stretch;
+      int n   = springs.size();
+      qreal c = springs[0].stretch;
       if (c == 0.0)           //DEBUG
             c = 1.1;
       qreal f = 0.0;
-      for (; i != springs.end();) {
-            xMin -= i->second.fix;
+      for (int i = 0; i < n;) {
+            xMin -= springs[i].fix;
             f = (x - xMin) / c;
             ++i;
-            if (i == springs.end() || f <= i->first)
+            if (i == n || f <= springs[i].force)
                   break;
-            c += i->second.stretch;
+            c += springs[i].stretch;
             }
       return f;
       }
 
 #define T(...) if (_no == 1) printf(__VA_ARGS__);
 
-//-----------------------------------------------------------------------------
-//    layoutX
-///   \brief main layout routine for note spacing
-///   Return width of measure (in MeasureWidth), taking into account \a stretch.
-///   In the layout process this method is called twice, first with stretch==1
-///   to find out the minimal width of the measure.
-//-----------------------------------------------------------------------------
+//---------------------------------------------------------
+//   layoutSpacing
+//    minimum width pass of layoutX(): lay out all
+//    segment elements and compute the minimum segment
+//    positions and the spring table into _spacing
+//---------------------------------------------------------
 
-void Measure::layoutX(qreal stretch)
+void Measure::layoutSpacing(bool header)
       {
-      if (!_dirty && (stretch == 1.0))
-            return;
       int nstaves = _score->nstaves();
-
       int segs = 0;
       for (const Segment* s = first(); s; s = s->next()) {
             if (s->subtype() == SegClef && (s != first()))
@@ -2780,14 +2767,17 @@ void Measure::layoutX(qreal stretch)
             ++segs;
             }
 
-      if (nstaves == 0 || segs == 0) {
-            _mw = MeasureWidth(1.0, 0.0);
-            _dirty = false;
+      _spacing.valid      = true;
+      _spacing.generation = generation();
+      _spacing.spatium    = spatium();
+      _spacing.nstaves    = nstaves;
+      _spacing.header     = header;
+      _spacing.segs       = (nstaves == 0) ? 0 : segs;
+      _spacing.lyricsDistance.fill(0.0, nstaves);
+      if (nstaves == 0 || segs == 0)
             return;
-            }
 
       qreal _spatium           = spatium();
-      int tracks                = nstaves * VOICES;
       qreal clefKeyRightMargin = score()->styleS(ST_clefKeyRightMargin).val() * _spatium;
 
       qreal rest[nstaves];    // fixed space needed from previous segment
@@ -2796,9 +2786,12 @@ void Measure::layoutX(qreal stretch)
       int ticksList[segs];
       memset(ticksList, 0, segs * sizeof(int));
 
-      qreal xpos[segs+1];
-      SegmentType types[segs];
-      qreal width[segs];
+      _spacing.xpos.resize(segs + 1);
+      _spacing.width.resize(segs);
+      _spacing.types.resize(segs);
+      qreal* xpos       = _spacing.xpos.data();
+      qreal* width      = _spacing.width.data();
+      SegmentType* types = _spacing.types.data();
 
       int segmentIdx  = 0;
       qreal x        = 0.0;
@@ -2887,8 +2880,8 @@ void Measure::layoutX(qreal stretch)
                               }
                         if (lyrics) {
                               qreal y = lyrics->ipos().y() + point(score()->styleS(ST_lyricsMinBottomDistance));
-                              if (y > staves[staffIdx]->distanceDown)
-                                 staves[staffIdx]->distanceDown = y;
+                              if (y > _spacing.lyricsDistance[staffIdx])
+                                    _spacing.lyricsDistance[staffIdx] = y;
                               space.max(Space(llw, rrw));
                               }
                         }
@@ -2971,37 +2964,17 @@ void Measure::layoutX(qreal stretch)
                   ticksList[segmentIdx] = 0;
             }
 
-      for (int staffIdx = 0; staffIdx < nstaves; ++staffIdx) {
-            qreal distAbove;
-            Staff * staff = _score->staff(staffIdx);
-            if (staff->useTablature()) {
-                  distAbove = -((StaffTypeTablature*)(staff->staffType()))->durationBoxY();
-                  if (distAbove > staves[staffIdx]->distanceUp)
-                     staves[staffIdx]->distanceUp = distAbove;
-                  }
-            }
       qreal segmentWidth = 0.0;
       for (int staffIdx = 0; staffIdx < nstaves; ++staffIdx)
             segmentWidth = qMax(segmentWidth, rest[staffIdx]);
       xpos[segmentIdx]    = x + segmentWidth;
       width[segmentIdx-1] = segmentWidth;
 
-      if (stretch == 1.0) {
-            // printf("this is pass 1\n");
-            _mw = MeasureWidth(xpos[segs], 0.0);
-            _dirty = false;
-            return;
-            }
-
       //---------------------------------------------------
-      // compute stretches
+      // compute springs
       //---------------------------------------------------
 
-      SpringMap springs;
-//      qreal stretchList[segs];
-      qreal stretchSum = 0.0;
-//      stretchList[0]    = 0.0;
-
+      _spacing.springs.clear();
       qreal minimum = xpos[0];
       for (int i = 0; i < segs; ++i) {
             qreal str = 1.0;
@@ -3013,30 +2986,86 @@ void Measure::layoutX(qreal stretch)
                   if (minTick > 0)
                         str += .6 * log2(qreal(t) / qreal(minTick));
                   d = w / str;
-                  stretchSum += str;
                   }
             else {
                   str = 0.0;              // dont stretch timeSig and key
                   d   = 100000000.0;      // CHECK
                   }
-//            stretchList[i] = str;
-            springs.insert(std::pair<qreal, Spring>(d, Spring(i, str, w)));
+            _spacing.springs.append(Spring(d, i, str, w));
             minimum += w;
             }
+      qStableSort(_spacing.springs.begin(), _spacing.springs.end());
+      _spacing.minimum = minimum;
+      }
+
+//-----------------------------------------------------------------------------
+//    layoutX
+///   \brief main layout routine for note spacing
+///   Return width of measure (in MeasureWidth), taking into account \a stretch.
+///   In the layout process this method is called twice, first with stretch==1
+///   to find out the minimal width of the measure. The minimum width pass is
+///   memoized in _spacing and only redone if the key changes.
+//-----------------------------------------------------------------------------
+
+void Measure::layoutX(qreal stretch)
+      {
+      int nstaves  = _score->nstaves();
+      System* sys  = system();
+      bool header  = sys && sys->firstMeasure() == this;
+      bool hit     = _spacing.valid
+         && _spacing.generation == generation()
+         && _spacing.spatium == spatium()
+         && _spacing.nstaves == nstaves
+         && _spacing.header == header;
+      _score->countSpacing(hit);
+      if (!hit)
+            layoutSpacing(header);
+      _dirty = false;
+
+      int segs = _spacing.segs;
+      if (segs == 0) {
+            _mw = MeasureWidth(1.0, 0.0);
+            return;
+            }
+      for (int staffIdx = 0; staffIdx < nstaves; ++staffIdx) {
+            qreal y = _spacing.lyricsDistance[staffIdx];
+            if (y > staves[staffIdx]->distanceDown)
+                  staves[staffIdx]->distanceDown = y;
+            Staff * staff = _score->staff(staffIdx);
+            if (staff->useTablature()) {
+                  qreal distAbove = -((StaffTypeTablature*)(staff->staffType()))->durationBoxY();
+                  if (distAbove > staves[staffIdx]->distanceUp)
+                     staves[staffIdx]->distanceUp = distAbove;
+                  }
+            }
+
+      if (stretch == 1.0) {
+            // printf("this is pass 1\n");
+            _mw = MeasureWidth(_spacing.xpos[segs], 0.0);
+            return;
+            }
+
+      qreal _spatium           = spatium();
+      int tracks                = nstaves * VOICES;
+      qreal clefKeyRightMargin = score()->styleS(ST_clefKeyRightMargin).val() * _spatium;
+      const SegmentType* types = _spacing.types.constData();
 
       //---------------------------------------------------
       //    distribute stretch to segments
       //---------------------------------------------------
 
-      qreal force = sff(stretch, minimum, springs);
+      qreal xpos[segs+1];
+      qreal width[segs];
+      qreal force = sff(stretch, _spacing.minimum, _spacing.springs);
 
-      for (iSpring i = springs.begin(); i != springs.end(); ++i) {
-            qreal stretch = force * i->second.stretch;
-            if (stretch < i->second.fix)
-                  stretch = i->second.fix;
-            width[i->second.seg] = stretch;
+      foreach(const Spring& spring, _spacing.springs) {
+            qreal stretch = force * spring.stretch;
+            if (stretch < spring.fix)
+                  stretch = spring.fix;
+            width[spring.seg] = stretch;
             }
-      x = xpos[0];
+      qreal x = _spacing.xpos[0];
+      xpos[0] = x;
       for (int i = 1; i <= segs; ++i) {
             x += width[i-1];
             xpos[i] = x;
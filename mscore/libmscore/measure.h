@@ -70,6 +70,48 @@ struct MStaff {
       void setTrack(int);
       };
 
+//---------------------------------------------------------
+//   Spring
+//---------------------------------------------------------
+
+struct Spring {
+      qreal force;            ///< force at which the spring leaves its fixed width
+      int seg;
+      qreal stretch;
+      qreal fix;
+
+      Spring() {}
+      Spring(qreal d, int i, qreal s, qreal f) : force(d), seg(i), stretch(s), fix(f) {}
+      bool operator<(const Spring& s) const { return force < s.force; }
+      };
+
+//---------------------------------------------------------
+//   MeasureSpacing
+//    memo of the minimum width pass of layoutX(): segment
+//    positions and the spring table. It is used by system
+//    breaking (layoutX(1.0)) and by stretching (layout(w))
+//    as long as the key matches. Style changes always go
+//    through layoutStage1(), which bumps the generation.
+//---------------------------------------------------------
+
+struct MeasureSpacing {
+      bool valid;
+      int generation;               ///< MeasureBase::generation()
+      qreal spatium;
+      int nstaves;
+      bool header;                  ///< measure started a system
+
+      int segs;
+      QVector<qreal> xpos;          ///< minimum segment positions, segs+1 entries
+      QVector<qreal> width;         ///< minimum segment widths
+      QVector<SegmentType> types;
+      QVector<qreal> lyricsDistance; ///< distanceDown needed for lyrics, per staff
+      QVector<Spring> springs;      ///< sorted by force
+      qreal minimum;                ///< width of the measure with all springs at rest
+
+      MeasureSpacing() { valid = false; }
+      };
+
 enum {
       RepeatEnd         = 1,
       RepeatStart       = 2,
@@ -126,6 +168,8 @@ class Measure : public MeasureBase {
 
       QColor _endBarLineColor;
 
+      MeasureSpacing _spacing;
+
       void push_back(Segment* e);
       void push_front(Segment* e);
 
@@ -186,6 +230,7 @@ class Measure : public MeasureBase {
       void setUserStretch(qreal v)        { _userStretch = v;    }
 
       void layoutX(qreal stretch);
+      void layoutSpacing(bool header);
       void layout(qreal width);
       void layout2();
 
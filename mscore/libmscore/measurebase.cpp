@@ -32,10 +32,12 @@ MeasureBase::MeasureBase(Score* score)
       {
       _prev = 0;
       _next = 0;
+      _tick = 0;
       _lineBreak    = false;
       _pageBreak    = false;
       _sectionBreak = 0;
       _dirty        = true;
+      _generation   = 0;
       }
 
 MeasureBase::MeasureBase(const MeasureBase& m)
@@ -46,6 +48,7 @@ MeasureBase::MeasureBase(const MeasureBase& m)
       _tick         = m._tick;
       _mw           = m._mw;
       _dirty        = m._dirty;
+      _generation   = m._generation;
       _lineBreak    = m._lineBreak;
       _pageBreak    = m._pageBreak;
       _sectionBreak = m._sectionBreak ? new LayoutBreak(*m._sectionBreak) : 0;
@@ -64,6 +64,7 @@ class MeasureBase : public Element {
                               ///< but outside the staff
 
       bool _dirty;
+      int _generation;        ///< incremented on every setDirty(), keys layout memos
       bool _lineBreak;        ///< Forced line break
       bool _pageBreak;        ///< Forced page break
       LayoutBreak* _sectionBreak;
@@ -112,8 +113,9 @@ class MeasureBase : public Element {
 
       virtual void add(Element*);
       virtual void remove(Element*);
-      void setDirty(bool val = true)         { _dirty = val;  }
+      void setDirty(bool val = true)         { _dirty = val; if (val) ++_generation; }
       bool dirty() const                     { return _dirty; }
+      int generation() const                 { return _generation; }
       int tick() const                       { return _tick;  }
       int endTick() const                    { return tick() + ticks();  }
       void setTick(int t)                    { _tick = t;     }
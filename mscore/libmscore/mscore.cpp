@@ -14,6 +14,7 @@
 #include "config.h"
 #include "style.h"
 #include "mscore.h"
+#include "dsp.h"
 
 qreal PDPI;
 qreal DPI;
@@ -45,6 +46,7 @@ QString MScore::partStyle;
 QString MScore::soundFont;
 qreal   MScore::spatium;
 QString MScore::lastError;
+QString MScore::cacheDir;
 bool    MScore::layoutDebug = false;
 int     MScore::division = 480;
 int     MScore::sampleRate = 44100;
@@ -62,6 +64,7 @@ extern void initDrumset();
 void MScore::init()
       {
       spatium = SPATIUM20;
+      initDsp();
 
 #ifdef __MINGW32__
       QDir dir(QCoreApplication::applicationDirPath() + QString("/../" INSTALL_NAME));
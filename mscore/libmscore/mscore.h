@@ -587,6 +587,7 @@ class MScore {
       static QString partStyle;
       static QString soundFont;
       static QString lastError;
+      static QString cacheDir;            ///< binary caches of share/ data, no caching if empty
       static bool layoutDebug;
 
       static qreal spatium;
@@ -127,7 +127,9 @@ Page::Page(Score* s)
    : Element(s),
    _no(0)
       {
-      bspTreeValid = false;
+      bspTreeValid    = false;
+      _bspRebuilds    = 0;
+      _bspRebuildTime = 0;
       }
 
 Page::~Page()
@@ -152,6 +154,29 @@ QList<const Element*> Page::items(const QPointF& p)
       return bspTree.items(p);
       }
 
+//---------------------------------------------------------
+//   updateItem
+//    element e moved without relayout; oldRect is its
+//    previous page bounding rectangle
+//---------------------------------------------------------
+
+void Page::updateItem(const Element* e, const QRectF& oldRect)
+      {
+      if (bspTreeValid)
+            bspTree.update(e, oldRect);
+      }
+
+//---------------------------------------------------------
+//   bspStatistics
+//---------------------------------------------------------
+
+BspTree::Statistics Page::bspStatistics()
+      {
+      if (!bspTreeValid)
+            doRebuildBspTree();
+      return bspTree.statistics();
+      }
+
 //---------------------------------------------------------
 //   tm
 //---------------------------------------------------------
@@ -635,6 +660,9 @@ void PageFormat::writeMusicXML(Xml& xml, qreal conversion )
 
 void Page::doRebuildBspTree()
       {
+      QTime t;
+      t.start();
+
       QList<Element*> el;
       foreach(System* s, _systems) {
             foreach(MeasureBase* m, s->measures()) {
@@ -647,6 +675,13 @@ void Page::doRebuildBspTree()
       bspTree.initialize(abbox(), n);
       for (int i = 0; i < n; ++i)
             bspTree.insert(el.at(i));
+      bspTreeValid = true;
+
+      int ms = t.elapsed();
+      ++_bspRebuilds;
+      _bspRebuildTime += ms;
+      if (debugMode)
+            printf("Page %d: bsp tree rebuilt, %d elements, %d ms\n", _no, n, ms);
       }
 
 //---------------------------------------------------------
@@ -106,6 +106,8 @@ class Page : public Element {
       int _no;                      // page number
       BspTree bspTree;
       bool bspTreeValid;
+      int _bspRebuilds;             ///< number of bsp tree rebuilds
+      int _bspRebuildTime;          ///< accumulated rebuild time in ms
 
       QString replaceTextMacros(const QString&) const;
       void doRebuildBspTree();
@@ -141,6 +143,10 @@ class Page : public Element {
       QList<const Element*> items(const QRectF& r);
       QList<const Element*> items(const QPointF& p);
       void rebuildBspTree() { bspTreeValid = false; }
+      void updateItem(const Element*, const QRectF& oldRect);
+      BspTree::Statistics bspStatistics();
+      int bspRebuilds() const            { return _bspRebuilds;    }
+      int bspRebuildTime() const         { return _bspRebuildTime; }
       virtual QPointF pagePos() const { return QPointF(); }     ///< position in page coordinates
       };
 
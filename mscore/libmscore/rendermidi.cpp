@@ -44,6 +44,7 @@
 #include "tremolo.h"
 #include "noteevent.h"
 #include "segment.h"
+#include "excerpt.h"
 
 //---------------------------------------------------------
 //   updateChannel
@@ -427,6 +428,13 @@ void Score::updateRepeatList(bool expandRepeats)
             repeatList()->unwind();
       if (debugMode)
             repeatList()->dump();
+      // the repeat list is shared with all excerpts
+      Score* root = rootScore();
+      root->invalidateCursorMap();
+      foreach(Excerpt* e, *root->excerpts()) {
+            if (e->score())
+                  e->score()->invalidateCursorMap();
+            }
       setPlaylistDirty(true);
       }
 
@@ -88,6 +88,80 @@ MeasureBaseList::MeasureBaseList()
       _size  = 0;
       };
 
+//---------------------------------------------------------
+//   indexPos
+//    Position of m in the index. The index holds all
+//    measures in list order and is updated on every change
+//    of the list, so index() never writes and can be called
+//    from several threads. The ticks are only used as a
+//    hint, as they may not be updated yet.
+//---------------------------------------------------------
+
+static bool measureTickLessThan(const Measure* m, int tick)
+      {
+      return m->tick() < tick;
+      }
+
+int MeasureBaseList::indexPos(const Measure* m) const
+      {
+      int tick = m->tick();
+      QVector<Measure*>::const_iterator i = qLowerBound(_index.begin(), _index.end(), tick, measureTickLessThan);
+      for (; i != _index.end() && (*i)->tick() == tick; ++i) {
+            if (*i == m)
+                  return i - _index.begin();
+            }
+      return _index.indexOf(const_cast<Measure*>(m));
+      }
+
+//---------------------------------------------------------
+//   indexInsert
+//    add the measures from fm to lm to the index; they
+//    are already linked into the list
+//---------------------------------------------------------
+
+void MeasureBaseList::indexInsert(MeasureBase* fm, MeasureBase* lm)
+      {
+      QVector<Measure*> ml;
+      for (MeasureBase* mb = fm;; mb = mb->next()) {
+            if (mb->type() == MEASURE)
+                  ml.append(static_cast<Measure*>(mb));
+            if (mb == lm)
+                  break;
+            }
+      if (ml.isEmpty())
+            return;
+      MeasureBase* nm = lm->next();
+      while (nm && nm->type() != MEASURE)
+            nm = nm->next();
+      int pos = nm ? indexPos(static_cast<Measure*>(nm)) : _index.size();
+      _index.insert(pos, ml.size(), 0);
+      for (int i = 0; i < ml.size(); ++i)
+            _index[pos + i] = ml[i];
+      }
+
+//---------------------------------------------------------
+//   indexRemove
+//    remove the measures from fm to lm from the index;
+//    they are contiguous there
+//---------------------------------------------------------
+
+void MeasureBaseList::indexRemove(MeasureBase* fm, MeasureBase* lm)
+      {
+      Measure* m = 0;
+      int n      = 0;
+      for (MeasureBase* mb = fm;; mb = mb->next()) {
+            if (mb->type() == MEASURE) {
+                  if (m == 0)
+                        m = static_cast<Measure*>(mb);
+                  ++n;
+                  }
+            if (mb == lm)
+                  break;
+            }
+      if (n)
+            _index.remove(indexPos(m), n);
+      }
+
 //---------------------------------------------------------
 //   push_back
 //---------------------------------------------------------
@@ -106,6 +180,8 @@ void MeasureBaseList::push_back(MeasureBase* e)
             e->setNext(0);
             }
       _last = e;
+      if (e->type() == MEASURE)
+            _index.append(static_cast<Measure*>(e));
       }
 
 //---------------------------------------------------------
@@ -126,6 +202,8 @@ void MeasureBaseList::push_front(MeasureBase* e)
             e->setNext(0);
             }
       _first = e;
+      if (e->type() == MEASURE)
+            _index.prepend(static_cast<Measure*>(e));
       }
 
 //---------------------------------------------------------
@@ -149,6 +227,7 @@ void MeasureBaseList::add(MeasureBase* e)
       e->setPrev(el->prev());
       el->prev()->setNext(e);
       el->setPrev(e);
+      indexInsert(e, e);
       }
 
 //---------------------------------------------------------
@@ -158,6 +237,7 @@ void MeasureBaseList::add(MeasureBase* e)
 void MeasureBaseList::remove(MeasureBase* el)
       {
       --_size;
+      indexRemove(el, el);
       if (el->prev())
             el->prev()->setNext(el->next());
       else
@@ -187,6 +267,7 @@ void MeasureBaseList::insert(MeasureBase* fm, MeasureBase* lm)
             nm->setPrev(lm);
       else
             _last = lm;
+      indexInsert(fm, lm);
       for (MeasureBase* mb = fm;;) {
             if (mb->type() == MEASURE) {
                   Measure* m = static_cast<Measure*>(mb);
@@ -218,6 +299,7 @@ void MeasureBaseList::remove(MeasureBase* fm, MeasureBase* lm)
       --_size;
       for (MeasureBase* m = fm; m != lm; m = m->next())
             --_size;
+      indexRemove(fm, lm);
       MeasureBase* pm = fm->prev();
       MeasureBase* nm = lm->next();
       if (pm)
@@ -236,6 +318,7 @@ void MeasureBaseList::remove(MeasureBase* fm, MeasureBase* lm)
 
 void MeasureBaseList::change(MeasureBase* ob, MeasureBase* nb)
       {
+      int pos = ob->type() == MEASURE ? indexPos(static_cast<Measure*>(ob)) : -1;
       nb->setPrev(ob->prev());
       nb->setNext(ob->next());
       if (ob->prev())
@@ -246,6 +329,12 @@ void MeasureBaseList::change(MeasureBase* ob, MeasureBase* nb)
             _last = nb;
       if (ob == _first)
             _first = nb;
+      if (pos != -1 && nb->type() == MEASURE)
+            _index[pos] = static_cast<Measure*>(nb);
+      else if (pos != -1)
+            _index.remove(pos);
+      else
+            indexInsert(nb, nb);
       if (nb->type() == HBOX || nb->type() == VBOX || nb->type() == TBOX || nb->type() == FBOX)
             nb->setSystem(ob->system());
       foreach(Element* e, *nb->el())
@@ -282,6 +371,7 @@ void Score::init()
 
       _updateAll      = true;
       _layoutAll      = true;
+      _layoutPending  = false;
       layoutFlags     = 0;
       _playNote       = false;
       _excerptsChanged = false;
@@ -297,6 +387,8 @@ void Score::init()
       _playlistDirty  = false;
       _autosaveDirty  = false;
       _dirty          = false;
+      _spacingHits    = 0;
+      _spacingMisses  = 0;
       _saved          = false;
       _playPos        = 0;
       _fileDivision   = MScore::division;
@@ -994,6 +1086,28 @@ int Score::midiChannel(int idx) const
       return _midiMapping[idx].channel;
       }
 
+//---------------------------------------------------------
+//   firstPage
+//    return index of the first page whose right edge is
+//    at or right of canvas position x; pages are laid out
+//    from left to right
+//---------------------------------------------------------
+
+static int firstPage(const QList<Page*>& pl, qreal x)
+      {
+      int lo = 0;
+      int hi = pl.size();
+      while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            const Page* page = pl.at(mid);
+            if (page->x() + page->bbox().right() < x)
+                  lo = mid + 1;
+            else
+                  hi = mid;
+            }
+      return lo;
+      }
+
 //---------------------------------------------------------
 //   searchPage
 //    p is in canvas coordinates
@@ -1001,13 +1115,102 @@ int Score::midiChannel(int idx) const
 
 Page* Score::searchPage(const QPointF& p) const
       {
-      foreach(Page* page, pages()) {
+      int idx = firstPage(_pages, p.x());
+      if (idx < _pages.size()) {
+            Page* page = _pages.at(idx);
             if (page->bbox().translated(page->pos()).contains(p))
                   return page;
             }
       return 0;
       }
 
+//---------------------------------------------------------
+//   items
+//    return all elements whose bounding box intersects
+//    r on any page; r is in canvas coordinates
+//---------------------------------------------------------
+
+QList<const Element*> Score::items(const QRectF& r) const
+      {
+      QList<const Element*> el;
+      for (int i = firstPage(_pages, r.left()); i < _pages.size(); ++i) {
+            Page* page = _pages.at(i);
+            if (page->x() > r.right())
+                  break;
+            QRectF pr(r.translated(-page->pos()));
+            if (!page->bbox().intersects(pr))
+                  continue;
+            QList<const Element*> l = page->items(pr);
+            foreach(const Element* e, l)
+                  e->itemDiscovered = 0;
+            el += l;
+            }
+      return el;
+      }
+
+//---------------------------------------------------------
+//   nearestElement
+//    return the selectable element closest to p within
+//    maxDistance, ignoring pages and measures which
+//    cover the whole area; p is in canvas coordinates
+//---------------------------------------------------------
+
+Element* Score::nearestElement(const QPointF& p, qreal maxDistance) const
+      {
+      QRectF r(p.x() - maxDistance, p.y() - maxDistance, 2.0 * maxDistance, 2.0 * maxDistance);
+      const Element* nearest = 0;
+      qreal minDistance      = maxDistance * maxDistance;
+      foreach(const Element* e, items(r)) {
+            if (e->type() == PAGE || e->type() == MEASURE || !e->selectable())
+                  continue;
+            QRectF b(e->canvasBoundingRect());
+            qreal dx = qMax(qMax(b.left() - p.x(), p.x() - b.right()), 0.0);
+            qreal dy = qMax(qMax(b.top() - p.y(), p.y() - b.bottom()), 0.0);
+            qreal d  = dx * dx + dy * dy;
+            if (d > minDistance)
+                  continue;
+            if (nearest && d == minDistance && e->z() <= nearest->z())
+                  continue;
+            nearest     = e;
+            minDistance = d;
+            }
+      return const_cast<Element*>(nearest);
+      }
+
+//---------------------------------------------------------
+//   rebuildBspTree
+//    invalidate the bsp trees of all pages intersecting
+//    r; r is in canvas coordinates
+//---------------------------------------------------------
+
+void Score::rebuildBspTree(const QRectF& r)
+      {
+      for (int i = firstPage(_pages, r.left()); i < _pages.size(); ++i) {
+            Page* page = _pages.at(i);
+            if (page->x() > r.right())
+                  break;
+            if (page->bbox().translated(page->pos()).intersects(r))
+                  page->rebuildBspTree();
+            }
+      }
+
+//---------------------------------------------------------
+//   updateItem
+//    element e moved without relayout (dragging), update
+//    the bsp tree of its page; oldRect is the previous
+//    page bounding rectangle of e
+//---------------------------------------------------------
+
+void Score::updateItem(const Element* e, const QRectF& oldRect)
+      {
+      for (Element* p = e->parent(); p; p = p->parent()) {
+            if (p->type() == PAGE) {
+                  static_cast<Page*>(p)->updateItem(e, oldRect);
+                  break;
+                  }
+            }
+      }
+
 //---------------------------------------------------------
 //   searchSystem
 //    return list of systems as there may be more than
@@ -1053,6 +1256,19 @@ QList<System*> Score::searchSystem(const QPointF& pos) const
       return systems;
       }
 
+//---------------------------------------------------------
+//   cursorPos
+//    return measure and x canvas position of the playback
+//    cursor at unrolled tick utick
+//---------------------------------------------------------
+
+Measure* Score::cursorPos(int utick, qreal* x)
+      {
+      if (!_cursorMap.valid())
+            _cursorMap.build(this);
+      return _cursorMap.find(utick, x);
+      }
+
 //---------------------------------------------------------
 //   searchMeasure
 //    p is in canvas coordinates
@@ -1066,11 +1282,21 @@ Measure* Score::searchMeasure(const QPointF& p) const
 
       foreach(System* system, systems) {
             qreal x = p.x() - system->canvasPos().x();
-            foreach(MeasureBase* mb, system->measures()) {
-                  if (mb->type() != MEASURE)
-                        continue;
+            const QList<MeasureBase*>& ml = system->measures();
+            // measures are ordered by x, find first one ending right of x
+            int lo = 0;
+            int hi = ml.size();
+            while (lo < hi) {
+                  int mid = (lo + hi) / 2;
+                  MeasureBase* mb = ml.at(mid);
                   if (x < (mb->x() + mb->bbox().width()))
-                        return static_cast<Measure*>(mb);
+                        hi = mid;
+                  else
+                        lo = mid + 1;
+                  }
+            for (int i = lo; i < ml.size(); ++i) {
+                  if (ml.at(i)->type() == MEASURE)
+                        return static_cast<Measure*>(ml.at(i));
                   }
             }
       return 0;
@@ -2110,6 +2336,17 @@ void Score::setSyntiState(const SyntiState& s)
             }
       }
 
+//---------------------------------------------------------
+//   addViewer
+//    a score which gets a view must be up to date
+//---------------------------------------------------------
+
+void Score::addViewer(MuseScoreView* v)
+      {
+      viewer.append(v);
+      doPendingLayout();
+      }
+
 //---------------------------------------------------------
 //   setLayoutAll
 //---------------------------------------------------------
@@ -3164,22 +3401,10 @@ void Score::lassoSelect(const QRectF& bbox)
       {
       select(0, SELECT_SINGLE, 0);
       QRectF fr(bbox.normalized());
-      foreach(Page* page, _pages) {
-            QRectF pr(page->bbox());
-            QRectF frr(fr.translated(-page->pos()));
-            if (pr.right() < frr.left())
-                  continue;
-            if (pr.left() > frr.right())
-                  break;
-
-            QList<const Element*> el = page->items(frr);
-            for (int i = 0; i < el.size(); ++i) {
-                  const Element* e = el.at(i);
-                  e->itemDiscovered = 0;
-                  if (frr.contains(e->abbox())) {
-                        if (e->type() != MEASURE && e->selectable())
-                              select(const_cast<Element*>(e), SELECT_ADD, 0);
-                        }
+      foreach(const Element* e, items(fr)) {
+            if (fr.contains(e->canvasBoundingRect())) {
+                  if (e->type() != MEASURE && e->selectable())
+                        select(const_cast<Element*>(e), SELECT_ADD, 0);
                   }
             }
       }
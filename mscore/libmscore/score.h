@@ -28,6 +28,8 @@
 #include "interval.h"
 #include "msynth/sparm.h"
 #include "mscoreview.h"
+#include "cursormap.h"
+#include "layoutcache.h"
 
 class TempoMap;
 struct TEvent;
@@ -83,6 +85,8 @@ class MuseScoreView;
 class LinkedElements;
 class Fingering;
 class Painter;
+struct ZipData;
+struct ScoreSnapshot;
 
 extern bool showRubberBand;
 
@@ -116,14 +120,20 @@ class MeasureBaseList {
       MeasureBase* _first;
       MeasureBase* _last;
 
+      QVector<Measure*> _index;     ///< measures in list order, which is tick order
+
       void push_back(MeasureBase* e);
       void push_front(MeasureBase* e);
+      int indexPos(const Measure*) const;
+      void indexInsert(MeasureBase*, MeasureBase*);
+      void indexRemove(MeasureBase*, MeasureBase*);
 
    public:
       MeasureBaseList();
       MeasureBase* first() const { return _first; }
       MeasureBase* last()  const { return _last; }
-      void clear()               { _first = _last = 0; _size = 0; }
+      void clear()               { _first = _last = 0; _size = 0; _index.clear(); }
+      const QVector<Measure*>& index() const { return _index; }
       void add(MeasureBase*);
       void remove(MeasureBase*);
       void insert(MeasureBase*, MeasureBase*);
@@ -271,6 +281,11 @@ class Score {
       bool _updateAll;
       Measure* startLayout;   ///< start a relayout at this measure
       bool _layoutAll;        ///< do a complete relayout
+      bool _layoutPending;    ///< layout deferred until a view, print or export needs it
+      CursorMap _cursorMap;   ///< utick -> playback cursor position, rebuilt after layout
+      LayoutCache _layoutCache; ///< layout saved with the score, used by the first layout after loading
+      int _spacingHits;       ///< layoutX() calls served from the measure spacing memo
+      int _spacingMisses;
       LayoutFlags layoutFlags;
       bool _playNote;         ///< play selected note after command
       bool _excerptsChanged;
@@ -292,6 +307,7 @@ class Score {
       bool _printing;   ///< True if we are drawing to a printer
       bool _playlistDirty;
       bool _autosaveDirty;
+      QByteArray _autosaveHash;     ///< sha1 of the score data last autosaved
       bool _dirty;      ///< Score data was modified.
       bool _saved;      ///< True if project was already saved; only on first
                         ///< save a backup file will be created, subsequent
@@ -536,6 +552,9 @@ class Score {
       void setUpdateAll(bool v = true) { _updateAll = v;   }
       void setLayoutAll(bool val);
       bool layoutAll() const           { return _layoutAll; }
+      bool layoutPending() const       { return _layoutPending; }
+      void deferLayout();
+      void doPendingLayout();
       void addRefresh(const QRectF& r) { refresh |= r;     }
 
       void changeVoice(int);
@@ -563,6 +582,9 @@ class Score {
       void saveFile(QIODevice* f, bool msczFormat, bool onlySelection = false);
       void saveCompressedFile(QFileInfo&, bool onlySelection);
       void saveCompressedFile(QIODevice*, QFileInfo&, bool onlySelection);
+      QList<ZipData> archiveEntries(const QString& fn);
+      QByteArray layoutCacheData(const QByteArray& scoreHash);
+      void snapshot(ScoreSnapshot*, const QString& path);
       bool exportFile();
 
       void print(Painter* printer, int page);
@@ -610,6 +632,8 @@ class Score {
       void setPrinting(bool val)     { _printing = val;      }
       void setAutosaveDirty(bool v)  { _autosaveDirty = v;    }
       bool autosaveDirty() const     { return _autosaveDirty; }
+      void setAutosaveHash(const QByteArray& h) { _autosaveHash = h; }
+      const QByteArray& autosaveHash() const    { return _autosaveHash; }
 
       void spell();
       void spell(int startStaff, int endStaff, Segment* startSegment, Segment* endSegment);
@@ -695,8 +719,15 @@ class Score {
       void lassoSelectEnd();
 
       Page* searchPage(const QPointF&) const;
+      QList<const Element*> items(const QRectF&) const;
+      Element* nearestElement(const QPointF&, qreal maxDistance) const;
+      void updateItem(const Element*, const QRectF& oldRect);
+      void rebuildBspTree(const QRectF&);
       QList<System*> searchSystem(const QPointF& p) const;
       Measure* searchMeasure(const QPointF& p) const;
+      Measure* cursorPos(int utick, qreal* x);
+      void invalidateCursorMap()       { _cursorMap.invalidate(); }
+      void countSpacing(bool hit)      { if (hit) ++_spacingHits; else ++_spacingMisses; }
 
       bool getPosition(Position* pos, const QPointF&, int voice) const;
 
@@ -746,7 +777,7 @@ class Score {
       int fileDivision() const { return _fileDivision; } ///< division of current loading *.msc file
       void splitStaff(int staffIdx, int splitPoint);
       QString tmpName() const           { return _tmpName;      }
-      void setTmpName(const QString& s) { _tmpName = s;         }
+      void setTmpName(const QString& s) { _tmpName = s; _autosaveHash.clear(); }
       void processMidiInput();
       Lyrics* addLyrics();
       void expandVoice(Segment* s, int track);
@@ -830,7 +861,7 @@ class Score {
 
       void transpose(int mode, TransposeDirection, int transposeKey, int transposeInterval,
          bool trKeys, bool transposeChordNames, bool useDoubleSharpsFlats);
-      void addViewer(MuseScoreView* v)      { viewer.append(v);   }
+      void addViewer(MuseScoreView* v);
       void removeViewer(MuseScoreView* v)   { viewer.removeAll(v); }
       void moveCursor();
       bool playNote() const                 { return _playNote; }
@@ -11,6 +11,12 @@
 //  the file LICENSE.GPL
 //=============================================================================
 
+#include <QtCore/QCryptographicHash>
+#ifdef __MINGW32__
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "score.h"
 #include "xml.h"
 #include "element.h"
@@ -32,6 +38,7 @@
 #include "painter.h"
 #include "excerpt.h"
 #include "zarchive/zarchive.h"
+#include "snapshot.h"
 #include "diff/diff_match_patch.h"
 #include "mscore.h"
 #include "stafftype.h"
@@ -145,8 +152,9 @@ void Score::write(Xml& xml, bool selectionOnly)
       xml.curTrack = -1;
       xml.tag("cursorTrack", _is.track());
       if (!selectionOnly) {
-            foreach(Excerpt* excerpt, _excerpts)
+            foreach(Excerpt* excerpt, _excerpts) {
                   excerpt->score()->write(xml, false);       // recursion
+                  }
             }
       if (parentScore())
             xml.tag("name", name());
@@ -368,23 +376,37 @@ void Score::saveCompressedFile(QFileInfo& info, bool onlySelection)
       }
 
 //---------------------------------------------------------
-//   saveCompressedFile
-//    file is already opened
+//   HashDevice
+//    write only device which passes everything on to
+//    another device and computes its sha1 hash
 //---------------------------------------------------------
 
-void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection)
+class HashDevice : public QIODevice
       {
-      Zip uz;
-      if (!uz.createArchive(f))
-            throw (QString("Cannot create compressed musescore file: " + uz.errorString()));
+      QIODevice* dev;
+      QCryptographicHash hash;
+
+   protected:
+      virtual qint64 readData(char*, qint64) { return -1; }
+      virtual qint64 writeData(const char* data, qint64 len) {
+            hash.addData(data, len);
+            return dev->write(data, len);
+            }
 
-      QDateTime dt;
-      if (debugMode)
-            dt = QDateTime(QDate(2007, 9, 10), QTime(12, 0));
-      else
-            dt = QDateTime::currentDateTime();
+   public:
+      HashDevice(QIODevice* d) : dev(d), hash(QCryptographicHash::Sha1) {}
+      virtual bool isSequential() const { return true; }
+      QByteArray result() const         { return hash.result(); }
+      };
 
-      QString fn = info.completeBaseName() + ".mscx";
+//---------------------------------------------------------
+//   archiveEntries
+//    container, images and OMR pages of a .mscz file
+//    whose score entry is named fn
+//---------------------------------------------------------
+
+QList<ZipData> Score::archiveEntries(const QString& fn)
+      {
       QBuffer cbuf;
       cbuf.open(QIODevice::ReadWrite);
       Xml xml(&cbuf);
@@ -407,10 +429,10 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
 
       xml.etag();
       xml.etag();
-      cbuf.seek(0);
-      if (!uz.createEntry("META-INF/container.xml", cbuf, dt))
-            throw(QString("Cannot add container.xml to zipfile '%1': ").arg(info.filePath())
-               + uz.errorString());
+      xml.flush();
+
+      QList<ZipData> entries;
+      entries.append(ZipData("META-INF/container.xml", cbuf.data()));
 
       // save images
       idx = 1;
@@ -421,8 +443,6 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
             QFileInfo fi(srcPath);
             QString suffix = fi.suffix();
             QString dstPath = QString("Pictures/pic%1.%2").arg(idx).arg(suffix);
-            QBuffer cbuf;
-            QByteArray ba;
             if (!ip->loaded()) {
                   QFile inFile(srcPath);
                   if (!inFile.open(QIODevice::ReadOnly))
@@ -431,12 +451,7 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
                   inFile.close();
                   ip->setLoaded(true);
                   }
-            cbuf.setBuffer(&(ip->buffer().buffer()));
-            if (!cbuf.open(QIODevice::ReadOnly))
-                  throw(QString("cannot open buffer cbuf"));
-            if (!uz.createEntry(dstPath, cbuf, dt, false, false, 0))
-                  throw(QString("Cannot add <%1> to zipfile as <%1>\n").arg(srcPath).arg(dstPath));
-            cbuf.close();
+            entries.append(ZipData(dstPath, ip->buffer().buffer(), false, 0));
             ip->setPath(dstPath);   // image now has local path
             ++idx;
             }
@@ -453,25 +468,183 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
                   QImage image = page->image();
                   if (!image.save(&cbuf, "PNG"))
                         throw(QString("cannot create image"));
-                  if (!cbuf.open(QIODevice::ReadOnly))
-                        throw(QString("cannot open buffer cbuf"));
-                  if (!uz.createEntry(path, cbuf, dt, false, true))
-                        throw(QString("Cannot add <%1> to zipfile\n").arg(path));
-                  cbuf.close();
+                  entries.append(ZipData(path, cbuf.data(), true));
                   }
             }
 #endif
+      return entries;
+      }
 
-      QBuffer dbuf;
-      dbuf.open(QIODevice::ReadWrite);
-      saveFile(&dbuf, true, onlySelection);
-      dbuf.seek(0);
-      if (!uz.createEntry(fn, dbuf, dt))
+//---------------------------------------------------------
+//   layoutCacheData
+//    the current layout as layout cache entry for the
+//    score file with sha1 hash scoreHash; empty if there
+//    is no valid layout or a layout is pending
+//---------------------------------------------------------
+
+QByteArray Score::layoutCacheData(const QByteArray& scoreHash)
+      {
+      if (_layoutPending || _systems.isEmpty())
+            return QByteArray();
+      LayoutCache lc;
+      lc.build(this);
+      lc.setKey(LayoutCache::computeKey(this, scoreHash));
+      QBuffer lbuf;
+      lbuf.open(QIODevice::ReadWrite);
+      Xml xml(&lbuf);
+      lc.write(xml);
+      xml.flush();
+      return lbuf.data();
+      }
+
+//---------------------------------------------------------
+//   saveCompressedFile
+//    file is already opened
+//---------------------------------------------------------
+
+void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection)
+      {
+      Zip uz;
+      if (!uz.createArchive(f))
+            throw (QString("Cannot create compressed musescore file: " + uz.errorString()));
+
+      QDateTime dt;
+      if (debugMode)
+            dt = QDateTime(QDate(2007, 9, 10), QTime(12, 0));
+      else
+            dt = QDateTime::currentDateTime();
+
+      //
+      // container, images and OMR pages are compressed in
+      // parallel; the score itself is streamed into the archive
+      //
+      QString fn = info.completeBaseName() + ".mscx";
+      QList<ZipData> entries = archiveEntries(fn);
+      if (!uz.createEntries(entries, dt))
+            throw(QString("Cannot add files to zipfile '%1': ").arg(info.filePath())
+               + uz.errorString());
+
+      if (!uz.beginEntry(fn, dt))
             throw(QString("Cannot add %1 to zipfile '%2'").arg(fn).arg(info.filePath()));
+      ZipEntryDevice dbuf(&uz);
+      dbuf.open(QIODevice::WriteOnly);
+      HashDevice hbuf(&dbuf);
+      hbuf.open(QIODevice::WriteOnly);
+      saveFile(&hbuf, true, onlySelection);
+      hbuf.close();
+      dbuf.close();
+      if (!uz.endEntry())
+            throw(QString("Cannot add %1 to zipfile '%2'").arg(fn).arg(info.filePath()));
+
+      //
+      // save the current layout so that the next load
+      // does not need to compute line breaks and measure widths
+      //
+      if (!onlySelection) {
+            QByteArray layout = layoutCacheData(hbuf.result());
+            if (!layout.isEmpty() && !uz.createEntry(ZipData("Layout/layout.xml", layout), dt))
+                  throw(QString("Cannot add layout cache to zipfile '%1'").arg(info.filePath()));
+            }
       if (!uz.closeArchive())
             throw(QString("Cannot close zipfile '%1'").arg(info.filePath()));
       }
 
+//---------------------------------------------------------
+//   snapshot
+//    serialize the score as autosave file path into
+//    memory; ScoreSnapshot::write() does the rest
+//---------------------------------------------------------
+
+void Score::snapshot(ScoreSnapshot* ss, const QString& path)
+      {
+      QFileInfo info(path);
+      ss->path = path;
+      if (debugMode)
+            ss->dt = QDateTime(QDate(2007, 9, 10), QTime(12, 0));
+      else
+            ss->dt = QDateTime::currentDateTime();
+      QString fn = info.completeBaseName() + ".mscx";
+      ss->entries = archiveEntries(fn);
+
+      QBuffer sbuf;
+      sbuf.open(QIODevice::WriteOnly);
+      HashDevice hbuf(&sbuf);
+      hbuf.open(QIODevice::WriteOnly);
+      saveFile(&hbuf, true, false);
+      hbuf.close();
+      ss->hash = hbuf.result();
+      ss->entries.append(ZipData(fn, sbuf.data()));
+
+      QByteArray layout = layoutCacheData(ss->hash);
+      if (!layout.isEmpty())
+            ss->entries.append(ZipData("Layout/layout.xml", layout));
+      }
+
+//---------------------------------------------------------
+//   write
+//    compress the snapshot into path.new, sync it to disk
+//    and rename it to path; called from a background
+//    thread
+//---------------------------------------------------------
+
+bool ScoreSnapshot::write()
+      {
+      QString tmp(path + ".new");
+      QFile f(tmp);
+      if (!f.open(QIODevice::WriteOnly)) {
+            printf("cannot create <%s>\n", qPrintable(tmp));
+            return false;
+            }
+      //
+      // the entries are compressed one after the other here;
+      // Zip::createEntries() would start more pool threads
+      // from this one
+      //
+      Zip* uz = new Zip;            // too large for the stack of a pool thread
+      bool ok = uz->createArchive(&f);
+      for (int i = 0; ok && i < entries.size(); ++i)
+            ok = uz->createEntry(entries[i], dt);
+      ok = ok && uz->closeArchive();
+      delete uz;
+      if (ok)
+            ok = f.flush();
+#ifdef __MINGW32__
+      if (ok)
+            ok = _commit(f.handle()) == 0;
+      f.close();
+      if (ok) {
+            QFile::remove(path);
+            ok = QFile::rename(tmp, path);
+            }
+#else
+      if (ok)
+            ok = fsync(f.handle()) == 0;
+      f.close();
+      if (ok)
+            ok = ::rename(QFile::encodeName(tmp).constData(), QFile::encodeName(path).constData()) == 0;
+#endif
+      if (!ok) {
+            printf("cannot write <%s>\n", qPrintable(path));
+            QFile::remove(tmp);
+            }
+      return ok;
+      }
+
+//---------------------------------------------------------
+//   writeSnapshots
+//    return the paths of all files written
+//---------------------------------------------------------
+
+QStringList writeSnapshots(QList<ScoreSnapshot> sl)
+      {
+      QStringList written;
+      for (int i = 0; i < sl.size(); ++i) {
+            if (sl[i].write())
+                  written.append(sl[i].path);
+            }
+      return written;
+      }
+
 //---------------------------------------------------------
 //   saveFile
 //    return true on success
@@ -642,12 +815,10 @@ bool Score::loadCompressedMsc(QString name)
             return false;
             }
 
-      QBuffer dbuf;
-      dbuf.open(QIODevice::WriteOnly);
-      uz.extractFile(rootfile, &dbuf);
+      QByteArray data = uz.fileData(rootfile);
 
       QDomDocument doc;
-      if (!doc.setContent(dbuf.data(), false, &err, &line, &column)) {
+      if (!doc.setContent(data, false, &err, &line, &column)) {
             QString col, ln;
             col.setNum(column);
             ln.setNum(line);
@@ -655,10 +826,18 @@ bool Score::loadCompressedMsc(QString name)
             printf("error: %s\n", qPrintable(error));
             return false;
             }
-      dbuf.close();
       docName = info.completeBaseName();
       bool retval = read1(doc.documentElement());
 
+      //
+      // use the saved layout if it was made from exactly this score
+      //
+      if (retval && uz.contains("Layout/layout.xml")) {
+            QByteArray key = LayoutCache::computeKey(this, QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+            if (!_layoutCache.read(uz.fileData("Layout/layout.xml"), key) && debugMode)
+                  printf("layout cache of %s is out of date\n", qPrintable(name));
+            }
+
 #ifdef OMR
       //
       // load OMR page images
@@ -1341,11 +1520,7 @@ QByteArray Score::readCompressedToBuffer()
             return QByteArray();
             }
 
-      QBuffer dbuf;
-      dbuf.open(QIODevice::WriteOnly);
-      uz.extractFile(rootfile, &dbuf);
-      dbuf.close();
-      return dbuf.data();
+      return uz.fileData(rootfile);
       }
 
 //---------------------------------------------------------
@@ -1399,6 +1574,51 @@ printf("createRevision\n");
 #endif
       }
 
+//---------------------------------------------------------
+//   addTrackSegment
+//---------------------------------------------------------
+
+static void addTrackSegment(QVector<QList<Segment*> >& tl, int idx, Segment* s)
+      {
+      QList<Segment*>& l = tl[idx];
+      if (l.isEmpty() || l.last() != s)
+            l.append(s);
+      }
+
+//---------------------------------------------------------
+//   trackSegments
+//    collect in one pass over the segments fs - ls the
+//    segments which may write something for each track
+//    of strack - etrack; most voices are empty and need
+//    not be visited at all
+//---------------------------------------------------------
+
+static QVector<QList<Segment*> > trackSegments(int strack, int etrack, Segment* fs, Segment* ls,
+   bool writeSystemElements)
+      {
+      QVector<QList<Segment*> > tl(etrack - strack);
+      for (Segment* segment = fs; segment && segment != ls; segment = segment->next1()) {
+            bool barLine = writeSystemElements && (segment->subtype() == SegEndBarLine);
+            for (int track = strack; track < etrack; ++track) {
+                  if (segment->element(track) || (barLine && (track % VOICES) == 0))
+                        addTrackSegment(tl, track - strack, segment);
+                  }
+            foreach(Element* e, segment->annotations()) {
+                  if (e->track() >= strack && e->track() < etrack && !e->generated())
+                        addTrackSegment(tl, e->track() - strack, segment);
+                  }
+            foreach(Spanner* e, segment->spannerFor()) {
+                  if (e->track() >= strack && e->track() < etrack && !e->generated())
+                        addTrackSegment(tl, e->track() - strack, segment);
+                  }
+            foreach(Spanner* e, segment->spannerBack()) {
+                  if (e->track() >= strack && e->track() < etrack && !e->generated())
+                        addTrackSegment(tl, e->track() - strack, segment);
+                  }
+            }
+      return tl;
+      }
+
 //---------------------------------------------------------
 //   writeSegments
 //---------------------------------------------------------
@@ -1406,8 +1626,9 @@ printf("createRevision\n");
 void Score::writeSegments(Xml& xml, const Measure* m, int strack, int etrack, Segment* fs, Segment* ls,
    bool writeSystemElements)
       {
+      QVector<QList<Segment*> > tl(trackSegments(strack, etrack, fs, ls, writeSystemElements));
       for (int track = strack; track < etrack; ++track) {
-            for (Segment* segment = fs; segment && segment != ls; segment = segment->next1()) {
+            foreach(Segment* segment, tl[track - strack]) {
                   Element* e = segment->element(track);
                   //
                   // special case: - barline span > 1
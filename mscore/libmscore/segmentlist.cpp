@@ -31,6 +31,20 @@ SegmentList SegmentList::clone() const
       return dl;
       }
 
+//---------------------------------------------------------
+//   rebuildIndex
+//    a measure has only a few segments, so insertions in the
+//    middle simply rebuild the index
+//---------------------------------------------------------
+
+void SegmentList::rebuildIndex()
+      {
+      _index.clear();
+      _index.reserve(_size);
+      for (Segment* s = _first; s; s = s->next())
+            _index.append(s);
+      }
+
 //---------------------------------------------------------
 //   check
 //---------------------------------------------------------
@@ -86,6 +100,7 @@ void SegmentList::insert(Segment* e, Segment* el)
       e->setPrev(el->prev());
       el->prev()->setNext(e);
       el->setPrev(e);
+      rebuildIndex();
       check();
       }
 
@@ -112,6 +127,7 @@ void SegmentList::remove(Segment* el)
             el->prev()->setNext(el->next());
             el->next()->setPrev(el->prev());
             }
+      rebuildIndex();
       check();
       }
 
@@ -133,6 +149,7 @@ void SegmentList::push_back(Segment* e)
             e->setNext(0);
             }
       _last = e;
+      _index.append(e);
       check();
       }
 
@@ -154,6 +171,7 @@ void SegmentList::push_front(Segment* e)
             e->setNext(0);
             }
       _first = e;
+      _index.prepend(e);
       check();
       }
 
@@ -205,6 +223,7 @@ void SegmentList::insert(Segment* seg)
       else
             _last = seg;
       ++_size;
+      rebuildIndex();
       check();
       }
 
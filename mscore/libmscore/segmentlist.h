@@ -25,10 +25,13 @@ class SegmentList {
       Segment* _first;        ///< First item of segment list
       Segment* _last;         ///< Last item of segment list
       int _size;              ///< Number of items in segment list
+      QVector<Segment*> _index; ///< segments in list order, for binary search by tick
+
+      void rebuildIndex();
 
    public:
       SegmentList()                        { clear(); }
-      void clear()                         { _first = _last = 0; _size = 0; }
+      void clear()                         { _first = _last = 0; _size = 0; _index.clear(); }
       void check();
 
       SegmentList clone() const;
@@ -39,6 +42,7 @@ class SegmentList {
 
       Segment* last() const                { return _last;        }
       Segment* firstCRSegment() const;
+      const QVector<Segment*>& index() const { return _index; }
       void remove(Segment*);
       void push_back(Segment*);
       void push_front(Segment*);
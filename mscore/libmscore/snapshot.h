@@ -0,0 +1,39 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include "zarchive/zarchive.h"
+
+//---------------------------------------------------------
+//   ScoreSnapshot
+//    the entries of a .mscz file serialized into memory
+//    by Score::snapshot(). It does not reference the score,
+//    so compressing and writing can run in a background
+//    thread while the score is edited.
+//---------------------------------------------------------
+
+struct ScoreSnapshot {
+      QString path;                 ///< destination file
+      QDateTime dt;                 ///< time stamp of the archive entries
+      QList<ZipData> entries;
+      QByteArray hash;              ///< sha1 of the score xml
+
+      bool write();
+      };
+
+extern QStringList writeSnapshots(QList<ScoreSnapshot>);
+
+#endif
+
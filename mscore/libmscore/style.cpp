@@ -1025,8 +1025,8 @@ ChordList* StyleData::chordList()  const
       {
       if (_chordList == 0) {
             _chordList = new ChordList();
-            _chordList->read("chords.xml");
-            _chordList->read(value(ST_chordDescriptionFile).toString());
+            _chordList->readCached(QStringList() << "chords.xml"
+               << value(ST_chordDescriptionFile).toString());
             }
       return _chordList;
       }
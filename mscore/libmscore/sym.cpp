@@ -19,6 +19,7 @@
 #include "xml.h"
 #include "painter.h"
 #include "mscore.h"
+#include "symtable.h"
 
 QVector<Sym> symbols[2];
 static bool symbolsInitialized[2] = { false, false };
@@ -626,48 +627,40 @@ QString symToHtml(const Sym& s1, const Sym& s2, int leftMargin)
       }
 
 //---------------------------------------------------------
-//   initSymbols
+//   tableSymbols
+//    take the glyph metrics from the table generated at
+//    build time; return false if the table was not made
+//    for the music font in use
 //---------------------------------------------------------
 
-void initSymbols(int idx)
+static bool tableSymbols(int idx, int fid, const QHash<QString, int>& lnhash)
       {
-#ifdef USE_GLYPHS
-      if (!fontsInitialized) {
-            // rawFonts[0] = new QRawFont(
+      const SymTableEntry* table = idx == 0 ? mscore20Table         : gonvilleTable;
+      int n                      = idx == 0 ? mscore20TableSize     : gonvilleTableSize;
+      qint64 fontSize            = idx == 0 ? mscore20TableFontSize : gonvilleTableFontSize;
+      QString font               = idx == 0 ? ":/fonts/mscore-20.otf" : ":/fonts/gonville-20.otf";
+
+      if (QFileInfo(font).size() != fontSize) {
+            printf("symbol table does not match font <%s>\n", qPrintable(font));
+            return false;
             }
-#endif
-      if (symbolsInitialized[idx])
-            return;
-      symbolsInitialized[idx] = true;
-
-#define MT(a) QT_TRANSLATE_NOOP("symbol", a)
-      symbols[idx] = QVector<Sym>(lastSym);
-      symbols[idx][clefEightSym] = Sym(MT("clef eight"), 0x38, 2);
-      symbols[idx][clefOneSym]   = Sym(MT("clef one"),   0x31, 2);
-      symbols[idx][clefFiveSym]  = Sym(MT("clef five"),  0x35, 2);
-      symbols[idx][letterfSym]   = Sym(MT("f"),          0x66, 1);
-      symbols[idx][lettermSym]   = Sym(MT("m"),          0x6d, 1);
-      symbols[idx][letterpSym]   = Sym(MT("p"),          0x70, 1);
-      symbols[idx][letterrSym]   = Sym(MT("r"),          0x72, 1);
-      symbols[idx][lettersSym]   = Sym(MT("s"),          0x73, 1);
-      symbols[idx][letterzSym]   = Sym(MT("z"),          0x7a, 1);
-      symbols[idx][letterTSym]   = Sym(MT("T"),          'T', 2);
-      symbols[idx][letterSSym]   = Sym(MT("S"),          'S', 2);
-      symbols[idx][letterPSym]   = Sym(MT("P"),          'P', 2);
-      // used for GUI:
-      symbols[idx][note2Sym]     = Sym(MT("note 1/4"),   0xe104, 1);
-      symbols[idx][note4Sym]     = Sym(MT("note 1/4"),  0x1d15f, 1);
-      symbols[idx][note8Sym]     = Sym(MT("note 1/8"),   0xe106, 1);
-      symbols[idx][note16Sym]    = Sym(MT("note 1/16"),  0xe107, 1);
-      symbols[idx][note32Sym]    = Sym(MT("note 1/32"),  0xe108, 1);
-      symbols[idx][note64Sym]    = Sym(MT("note 1/64"),  0xe109, 1);
-      symbols[idx][dotdotSym]    = Sym(MT("dot dot"),    0xe10b, 1);
-#undef MT
+      for (int i = 0; i < n; ++i) {
+            const SymTableEntry& e = table[i];
+            int idx1 = lnhash.value(e.name);
+            if (idx1 > 0)
+                  symbols[idx][idx1] = Sym(e.name, e.code, fid, QPointF(e.ax, e.ay),
+                     QRectF(e.bx, e.by, e.bw, e.bh));
+            }
+      return true;
+      }
 
-      QHash<QString, int> lnhash;
-      for (unsigned int i = 0; i < sizeof(lilypondNames)/sizeof(*lilypondNames); ++i)
-            lnhash[QString(lilypondNames[i].name)] = lilypondNames[i].msIndex;
+//---------------------------------------------------------
+//   readSymbols
+//    read glyph metrics from the font description
+//---------------------------------------------------------
 
+static void readSymbols(int idx, int fid, const QHash<QString, int>& lnhash)
+      {
       QString path = idx == 0 ? ":/fonts/mscore20.xml" : ":/fonts/gonville.xml";
       QFile f(path);
       if (!f.open(QFile::ReadOnly)) {
@@ -689,7 +682,6 @@ void initSymbols(int idx)
             }
       f.close();
       docName = f.fileName();
-      int fid = idx == 0 ? 0 : 3;
       for (QDomElement e = doc.documentElement(); !e.isNull(); e = e.nextSiblingElement()) {
             if (e.tagName() == "museScore") {
                   for (QDomElement ee = e.firstChildElement(); !ee.isNull();  ee = ee.nextSiblingElement()) {
@@ -733,6 +725,54 @@ void initSymbols(int idx)
             else
                   domError(e);
             }
+      }
+
+//---------------------------------------------------------
+//   initSymbols
+//---------------------------------------------------------
+
+void initSymbols(int idx)
+      {
+#ifdef USE_GLYPHS
+      if (!fontsInitialized) {
+            // rawFonts[0] = new QRawFont(
+            }
+#endif
+      if (symbolsInitialized[idx])
+            return;
+      symbolsInitialized[idx] = true;
+
+#define MT(a) QT_TRANSLATE_NOOP("symbol", a)
+      symbols[idx] = QVector<Sym>(lastSym);
+      symbols[idx][clefEightSym] = Sym(MT("clef eight"), 0x38, 2);
+      symbols[idx][clefOneSym]   = Sym(MT("clef one"),   0x31, 2);
+      symbols[idx][clefFiveSym]  = Sym(MT("clef five"),  0x35, 2);
+      symbols[idx][letterfSym]   = Sym(MT("f"),          0x66, 1);
+      symbols[idx][lettermSym]   = Sym(MT("m"),          0x6d, 1);
+      symbols[idx][letterpSym]   = Sym(MT("p"),          0x70, 1);
+      symbols[idx][letterrSym]   = Sym(MT("r"),          0x72, 1);
+      symbols[idx][lettersSym]   = Sym(MT("s"),          0x73, 1);
+      symbols[idx][letterzSym]   = Sym(MT("z"),          0x7a, 1);
+      symbols[idx][letterTSym]   = Sym(MT("T"),          'T', 2);
+      symbols[idx][letterSSym]   = Sym(MT("S"),          'S', 2);
+      symbols[idx][letterPSym]   = Sym(MT("P"),          'P', 2);
+      // used for GUI:
+      symbols[idx][note2Sym]     = Sym(MT("note 1/4"),   0xe104, 1);
+      symbols[idx][note4Sym]     = Sym(MT("note 1/4"),  0x1d15f, 1);
+      symbols[idx][note8Sym]     = Sym(MT("note 1/8"),   0xe106, 1);
+      symbols[idx][note16Sym]    = Sym(MT("note 1/16"),  0xe107, 1);
+      symbols[idx][note32Sym]    = Sym(MT("note 1/32"),  0xe108, 1);
+      symbols[idx][note64Sym]    = Sym(MT("note 1/64"),  0xe109, 1);
+      symbols[idx][dotdotSym]    = Sym(MT("dot dot"),    0xe10b, 1);
+#undef MT
+
+      QHash<QString, int> lnhash;
+      for (unsigned int i = 0; i < sizeof(lilypondNames)/sizeof(*lilypondNames); ++i)
+            lnhash[QString(lilypondNames[i].name)] = lilypondNames[i].msIndex;
+
+      int fid = idx == 0 ? 0 : 3;
+      if (!tableSymbols(idx, fid, lnhash))
+            readSymbols(idx, fid, lnhash);
 
       for (unsigned int i = 0; i < sizeof(lilypondNames)/sizeof(*lilypondNames); ++i) {
             int idx1 = lilypondNames[i].msIndex;
@@ -35,39 +35,56 @@ QRectF handleRect(const QPointF& pos)
       return QRectF(pos.x()-4, pos.y()-4, 8, 8);
       }
 
+//---------------------------------------------------------
+//   findMeasure
+//    binary search in the measure index; return the
+//    measure containing tick or 0. If several measures
+//    start at the same tick, the first of them which
+//    contains tick is returned, as a linear search would.
+//---------------------------------------------------------
+
+static bool tickLessThan(int tick, const Measure* m)
+      {
+      return tick < m->tick();
+      }
+
+static bool measureTickLessThan(const Measure* m, int tick)
+      {
+      return m->tick() < tick;
+      }
+
+static Measure* findMeasure(const QVector<Measure*>& ml, int tick)
+      {
+      QVector<Measure*>::const_iterator i = qUpperBound(ml.begin(), ml.end(), tick, tickLessThan);
+      if (i == ml.begin())
+            return 0;
+      int st = (*(i - 1))->tick();
+      for (QVector<Measure*>::const_iterator k = qLowerBound(ml.begin(), i, st, measureTickLessThan); k != i; ++k) {
+            if (tick < (*k)->tick() + (*k)->ticks())
+                  return *k;
+            }
+      return 0;
+      }
+
+static bool segmentTickLessThan(const Segment* s, int tick)
+      {
+      return s->tick() < tick;
+      }
+
 //---------------------------------------------------------
 //   tick2measure
 //---------------------------------------------------------
 
 Measure* Score::tick2measure(int tick) const
       {
-      for (MeasureBase* mb = first(); mb; mb = mb->next()) {
-            if (mb->type() != MEASURE)
-                  continue;
-            Measure* m = static_cast<Measure*>(mb);
-            int st = m->tick();
-            int l  = m->ticks();
-            if (tick >= st && tick < (st+l))
-                  return m;
-            // hack:
-            MeasureBase* nmb;
-            for (nmb = mb->next(); nmb; nmb = nmb->next()) {
-                  if (nmb->type() == MEASURE)
-                        break;
-                  }
-            if (nmb == 0)
-                  return m;
+      const QVector<Measure*>& ml = _measures.index();
+      if (ml.isEmpty()) {
+            printf("-tick2measure %d not found\n", tick);
+            return 0;
             }
-      printf("-tick2measure %d not found\n", tick);
-//      if (debugMode) {
-        printf("first %p\n", first());
-            for (MeasureBase* m = first(); m; m = m->next()) {
-                  int st = m->tick();
-                  int l  = m->ticks();
-                  printf("%d - %d\n", st, st+l);
-                  }
-//            }
-      return 0;
+      Measure* m = findMeasure(ml, tick);
+      // hack: return last measure if tick is not inside the score
+      return m ? m : ml.last();
       }
 
 //---------------------------------------------------------
@@ -97,15 +114,19 @@ Segment* Score::tick2segment(int tick, bool first, SegmentTypes st) const
             printf("   no segment for tick %d\n", tick);
             return 0;
             }
-      for (Segment* segment = m->first(st); segment;) {
-            int t1 = segment->tick();
-            Segment* nsegment = segment->next(st);
-            int t2 = nsegment ? nsegment->tick() : INT_MAX;
-            if (((tick == t1) && first) || ((tick == t1) && (tick < t2)))
-                  return segment;
-            segment = nsegment;
+      // binary search for the first segment at tick, then
+      // pick the first or last segment of type st at tick
+      const QVector<Segment*>& sl = m->segments()->index();
+      QVector<Segment*>::const_iterator i = qLowerBound(sl.begin(), sl.end(), tick, segmentTickLessThan);
+      Segment* found = 0;
+      for (; i != sl.end() && (*i)->tick() == tick; ++i) {
+            if (!((*i)->subtype() & st))
+                  continue;
+            found = *i;
+            if (first)
+                  break;
             }
-      return 0;
+      return found;
       }
 
 //---------------------------------------------------------
@@ -120,37 +141,31 @@ Segment* Score::tick2segment(int tick, bool first, SegmentTypes st) const
 Segment* Score::tick2segmentEnd(int track, int tick) const
       {
 //      printf("tick2segmentEnd(track=%d, tick=%d)", track, tick);
-      // loop over all measures
-      for (MeasureBase* mb = first(); mb; mb = mb->next()) {
-            if (mb->type() != MEASURE)
+      // the measure with st < tick <= st + ticks
+      Measure* m = findMeasure(_measures.index(), tick - 1);
+      if (m == 0)
+            return 0;
+      // loop over all segments
+      for (Segment* segment = m->first(); segment; segment = segment->next()) {
+            Element* el = segment->element(track);
+            if (!el)
                   continue;
-            Measure* m = static_cast<Measure*>(mb);
-            int st = m->tick();
-            int l  = m->ticks();
-            if (tick > st && tick <= (st+l)) {
-                  // loop over all segments
-                  for (Segment* segment = m->first(); segment; segment = segment->next()) {
-                        Element* el = segment->element(track);
-                        if (!el)
-                              continue;
-                        if (!el->isChordRest())
-                              continue;
-                        ChordRest* cr = static_cast<ChordRest*>(el);
-                        // TODO LVI: check if following is correct, see exceptions in
-                        // ExportMusicXml::chord() and ExportMusicXml::rest()
-                        int endTick = cr->tick() + cr->actualTicks();
-                        if (endTick < tick)
-                              continue; // not found yet
-                        else if (endTick == tick) {
-//                              printf(" found seg=%p at tick=%d\n", segment, cr->tick());
-                              return segment; // found it
-                              }
-                        else {
-                              // endTick > tick (beyond the tick we are looking for)
-//                              printf("\n");
-                              return 0;
-                              }
-                        }
+            if (!el->isChordRest())
+                  continue;
+            ChordRest* cr = static_cast<ChordRest*>(el);
+            // TODO LVI: check if following is correct, see exceptions in
+            // ExportMusicXml::chord() and ExportMusicXml::rest()
+            int endTick = cr->tick() + cr->actualTicks();
+            if (endTick < tick)
+                  continue; // not found yet
+            else if (endTick == tick) {
+//                  printf(" found seg=%p at tick=%d\n", segment, cr->tick());
+                  return segment; // found it
+                  }
+            else {
+                  // endTick > tick (beyond the tick we are looking for)
+//                  printf("\n");
+                  return 0;
                   }
             }
 //      printf("\n");
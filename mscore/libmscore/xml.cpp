@@ -142,9 +142,53 @@ Fraction readFraction(QDomElement e)
 
 void Xml::putLevel()
       {
-      int level = stack.size();
-      for (int i = 0; i < level * 2; ++i)
-            *this << ' ';
+      beginLine();
+      *this << line;
+      }
+
+//---------------------------------------------------------
+//   beginLine
+//    start a new output line in the scratch buffer with
+//    the indentation of the current level
+//---------------------------------------------------------
+
+void Xml::beginLine()
+      {
+      if (line.capacity() < 256)
+            line.reserve(256);
+      line.fill(' ', stack.size() * 2);
+      }
+
+//---------------------------------------------------------
+//   endLine
+//    terminate the line; the stream is only flushed
+//    after the outermost tag is closed
+//---------------------------------------------------------
+
+void Xml::endLine()
+      {
+      *this << '\n';
+      if (stack.isEmpty())
+            flush();
+      }
+
+//---------------------------------------------------------
+//   tagName
+//    return the preformatted start and end tag for name.
+//    The table is keyed by the string address; the
+//    content is compared to catch reused buffers.
+//---------------------------------------------------------
+
+const Xml::TagName& Xml::tagName(const char* name)
+      {
+      TagName& t = tagNames[name];
+      if (t.name != name) {
+            t.name  = name;
+            QString s(QLatin1String(name));
+            t.open  = QString("<%1>").arg(s);
+            t.close = QString("</%1>\n").arg(s.left(s.indexOf(' ')));
+            }
+      return t;
       }
 
 //---------------------------------------------------------
@@ -164,8 +208,8 @@ void Xml::header()
 void Xml::stag(const QString& s)
       {
       putLevel();
-      *this << '<' << s << '>' << endl;
-      stack.append(s.split(' ')[0]);
+      *this << '<' << s << ">\n";
+      stack.append(s.left(s.indexOf(' ')));
       }
 
 //---------------------------------------------------------
@@ -176,7 +220,8 @@ void Xml::stag(const QString& s)
 void Xml::etag()
       {
       putLevel();
-      *this << "</" << stack.takeLast() << '>' << endl;
+      *this << "</" << stack.takeLast() << '>';
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -194,7 +239,8 @@ void Xml::tagE(const char* format, ...)
       vsnprintf(buffer, BS, format, args);
     	*this << buffer;
       va_end(args);
-      *this << "/>" << endl;
+      *this << "/>";
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -225,7 +271,8 @@ void Xml::ntag(const char* name)
 
 void Xml::netag(const char* s)
       {
-      *this << "</" << s << '>' << endl;
+      *this << "</" << s << '>';
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -235,7 +282,7 @@ void Xml::netag(const char* s)
 
 void Xml::tag(const QString& name, QVariant data)
       {
-      QString ename(name.split(' ')[0]);
+      QString ename(name.left(name.indexOf(' ')));
 
       putLevel();
       switch(data.type()) {
@@ -294,6 +341,85 @@ void Xml::tag(const QString& name, QVariant data)
             }
       }
 
+//---------------------------------------------------------
+//   formatInt
+//    write the decimal digits of v backwards into the
+//    buffer ending at p; return the start of the number
+//---------------------------------------------------------
+
+template <class T> static char* formatInt(char* p, T v, bool negative)
+      {
+      *--p = 0;
+      do {
+            *--p = '0' + v % 10;
+            v /= 10;
+            } while (v);
+      if (negative)
+            *--p = '-';
+      return p;
+      }
+
+//---------------------------------------------------------
+//   numberTag
+//---------------------------------------------------------
+
+void Xml::numberTag(const char* name, const char* number)
+      {
+      const TagName& t = tagName(name);
+      beginLine();
+      line += t.open;
+      line += QLatin1String(number);
+      line += t.close;
+      *this << line;
+      }
+
+//---------------------------------------------------------
+//   tag
+//    fast paths for the common value types; the line is
+//    assembled in the scratch buffer and written at once.
+//    There is an overload for every integer type wider
+//    than int, so that a long or qint64 value is not an
+//    ambiguous call.
+//---------------------------------------------------------
+
+void Xml::tag(const char* name, int val)
+      {
+      char buffer[16];
+      unsigned v = val < 0 ? -unsigned(val) : unsigned(val);
+      numberTag(name, formatInt(buffer + sizeof(buffer), v, val < 0));
+      }
+
+void Xml::tag(const char* name, qint64 val)
+      {
+      char buffer[24];
+      quint64 v = val < 0 ? -quint64(val) : quint64(val);
+      numberTag(name, formatInt(buffer + sizeof(buffer), v, val < 0));
+      }
+
+void Xml::tag(const char* name, quint64 val)
+      {
+      char buffer[24];
+      numberTag(name, formatInt(buffer + sizeof(buffer), val, false));
+      }
+
+void Xml::tag(const char* name, double val)
+      {
+      const TagName& t = tagName(name);
+      beginLine();
+      line += t.open;
+      *this << line << val << t.close;
+      }
+
+void Xml::tag(const char* name, const QString& s)
+      {
+      const TagName& t = tagName(name);
+      beginLine();
+      line += t.open;
+      line += xmlString(s);
+      line += t.close;
+      *this << line;
+      }
+
 void Xml::tag(const char* name, const QWidget* g)
       {
       tag(name, QRect(g->pos(), g->size()));
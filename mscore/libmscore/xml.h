@@ -37,9 +37,26 @@ class Prop {
 class Xml : public QTextStream {
       static const int BS = 2048;
 
+      //---------------------------------------------------
+      //   TagName
+      //    preformatted start and end tag for a name
+      //---------------------------------------------------
+
+      struct TagName {
+            QByteArray name;
+            QString open;           ///< "<name attr=...>"
+            QString close;          ///< "</name>\n"
+            };
+
       QList<QString> stack;
-      void putLevel();
+      QHash<const char*, TagName> tagNames;
+      QString line;                 ///< scratch buffer for one output line
 
+      void putLevel();
+      void beginLine();
+      void endLine();
+      const TagName& tagName(const char*);
+      void numberTag(const char* name, const char* number);
 
    public:
       int curTick;            // used to optimize output
@@ -59,7 +76,7 @@ class Xml : public QTextStream {
       Xml(QIODevice* dev);
       Xml();
 
-      void sTag(const char* name, Spatium sp) { Xml::tag(name, QVariant(sp.val())); }
+      void sTag(const char* name, Spatium sp) { Xml::tag(name, sp.val()); }
       void pTag(const char* name, Placement);
       void fTag(const char* name, const Fraction&);
       void valueTypeTag(const char* name, ValueType t);
@@ -78,8 +95,15 @@ class Xml : public QTextStream {
       void prop(QList<Prop> pl) { foreach(Prop p, pl) prop(p); }
 
       void tag(const QString& name, QVariant data);
-      void tag(const char* name, const char* s)    { tag(name, QVariant(s)); }
-      void tag(const char* name, const QString& s) { tag(name, QVariant(s)); }
+      void tag(const char* name, int val);
+      void tag(const char* name, unsigned val)     { tag(name, int(val)); }
+      void tag(const char* name, qint64 val);
+      void tag(const char* name, quint64 val);
+      void tag(const char* name, long val)         { tag(name, qint64(val)); }
+      void tag(const char* name, unsigned long val) { tag(name, quint64(val)); }
+      void tag(const char* name, double val);
+      void tag(const char* name, const char* s)    { tag(name, QString(s)); }
+      void tag(const char* name, const QString& s);
       void tag(const char* name, const QWidget*);
 
       void writeHtml(const QString& s);
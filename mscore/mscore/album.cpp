@@ -84,6 +84,7 @@ void Album::print()
             Score* score = item->score;
             if (score == 0)
                   continue;
+            score->doPendingLayout();
             score->setPrinting(true);
             //
             // here we ignore the configured page offset
@@ -34,6 +34,9 @@
 #include "alsamidi.h"
 #include "libmscore/utils.h"
 #include "msynth/synti.h"
+#include "libmscore/dsp.h"
+
+static const int CONVERT_SIZE = 256;      // samples converted per block
 
 //---------------------------------------------------------
 //   AlsaDriver
@@ -405,21 +408,22 @@ int AlsaDriver::recover()
 
 //---------------------------------------------------------
 //   play_16le
+//    samples are clipped and converted in blocks by the
+//    dsp routines, then stored with the device stride
 //---------------------------------------------------------
 
 char* AlsaDriver::play_16le (const float* src, char* dst, int step, int nfrm)
       {
-      while (nfrm--) {
-            short d;
-            float s = *src++;
-            if (s >  1)
-                  d = 0x7fff;
-            else if (s < -1)
-                  d = 0x8001;
-            else
-                  d = (short)(0x7fff * s);
-            *((short*) dst) = d;
-            dst += step;
+      int buf[CONVERT_SIZE];
+      while (nfrm > 0) {
+            int n = qMin(nfrm, int(CONVERT_SIZE));
+            dsp->floatToInt(buf, src, n, 0x7fff);
+            for (int i = 0; i < n; ++i) {
+                  *((short*) dst) = buf[i];
+                  dst += step;
+                  }
+            src  += n;
+            nfrm -= n;
             }
       return dst;
       }
@@ -430,21 +434,19 @@ char* AlsaDriver::play_16le (const float* src, char* dst, int step, int nfrm)
 
 char* AlsaDriver::play_24le(const float* src, char* dst, int step, int nfrm)
       {
-      float   s;
-      int     d;
-
-      while (nfrm--) {
-            s = *src++;
-            if (s >  1)
-                  d = 0x007fffff;
-            else if (s < -1)
-                  d = 0x00800001;
-            else
-                  d = (int)(0x007fffff * s);
-            dst [0] = d;
-            dst [1] = d >> 8;
-            dst [2] = d >> 16;
-            dst += step;
+      int buf[CONVERT_SIZE];
+      while (nfrm > 0) {
+            int n = qMin(nfrm, int(CONVERT_SIZE));
+            dsp->floatToInt(buf, src, n, 0x007fffff);
+            for (int i = 0; i < n; ++i) {
+                  int d = buf[i];
+                  dst [0] = d;
+                  dst [1] = d >> 8;
+                  dst [2] = d >> 16;
+                  dst += step;
+                  }
+            src  += n;
+            nfrm -= n;
             }
       return dst;
       }
@@ -455,19 +457,16 @@ char* AlsaDriver::play_24le(const float* src, char* dst, int step, int nfrm)
 
 char* AlsaDriver::play_32le(const float* src, char* dst, int step, int nfrm)
       {
-      float   s;
-      int     d;
-
-      while (nfrm--) {
-            s = *src++;
-            if (s >  1)
-                  d = 0x007fffff;
-            else if (s < -1)
-                  d = 0x00800001;
-            else
-                  d = (int)(0x007fffff * s);
-            *((int *) dst) = d << 8;
-            dst += step;
+      int buf[CONVERT_SIZE];
+      while (nfrm > 0) {
+            int n = qMin(nfrm, int(CONVERT_SIZE));
+            dsp->floatToInt(buf, src, n, 0x007fffff);
+            for (int i = 0; i < n; ++i) {
+                  *((int *) dst) = buf[i] << 8;
+                  dst += step;
+                  }
+            src  += n;
+            nfrm -= n;
             }
       return dst;
       }
@@ -557,6 +557,12 @@ void ShowPageWidget::setElement(Element* e)
       Page* p = (Page*)e;
       ShowElementBase::setElement(e);
       pb.pageNo->setValue(p->no());
+      BspTree::Statistics st = p->bspStatistics();
+      pb.bspStats->setText(QString("bsp nodes: %1\nleaves: %2 (%3 empty)\n"
+         "entries: %4, max/leaf: %5\nrebuilds: %6, %7 ms")
+         .arg(st.nodes).arg(st.leaves).arg(st.emptyLeaves)
+         .arg(st.items).arg(st.maxItems)
+         .arg(p->bspRebuilds()).arg(p->bspRebuildTime()));
       }
 
 //---------------------------------------------------------
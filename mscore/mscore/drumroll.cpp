@@ -183,17 +183,16 @@ void DrumrollEditor::setStaff(Staff* st)
 
 void DrumrollEditor::updateSelection()
       {
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() == 1) {
-            QGraphicsItem* item = items[0];
-            Note* note = static_cast<Note*>(item->data(0).value<void*>());
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() == 1) {
+            Note* note = notes[0];
             pitch->setEnabled(true);
             pitch->setValue(note->pitch());
             veloType->setEnabled(true);
             velocity->setEnabled(true);
             updateVelocity(note);
             }
-      else if (items.size() == 0) {
+      else if (notes.size() == 0) {
             velocity->setValue(0);
             velocity->setEnabled(false);
             pitch->setValue(0);
@@ -221,23 +220,16 @@ void DrumrollEditor::selectionChanged()
       {
       updateSelection();
 //      _score->blockSignals(true);
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() == 1) {
-            QGraphicsItem* item = items[0];
-            Note* note = static_cast<Note*>(item->data(0).value<void*>());
-            if (note)
-                  _score->select(note, SELECT_SINGLE, 0);
-            }
-      else if (items.size() == 0) {
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() == 1)
+            _score->select(notes[0], SELECT_SINGLE, 0);
+      else if (notes.size() == 0) {
             _score->select(0, SELECT_SINGLE, 0);
             }
       else {
             _score->select(0, SELECT_SINGLE, 0);
-            foreach(QGraphicsItem* item, items) {
-                  Note* note = static_cast<Note*>(item->data(0).value<void*>());
-                  if (note)
-                        _score->select(note, SELECT_ADD, 0);
-                  }
+            foreach(Note* note, notes)
+                  _score->select(note, SELECT_ADD, 0);
             }
       _score->setUpdateAll();
       _score->end();
@@ -267,11 +259,10 @@ void DrumrollEditor::changeSelection(int)
 
 void DrumrollEditor::veloTypeChanged(int val)
       {
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() != 1)
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() != 1)
             return;
-      QGraphicsItem* item = items[0];
-      Note* note = (Note*)item->data(0).value<void*>();
+      Note* note = notes[0];
       if ((note == 0) || (ValueType(val) == note->veloType()))
             return;
 
@@ -325,11 +316,10 @@ void DrumrollEditor::updateVelocity(Note* note)
 
 void DrumrollEditor::velocityChanged(int val)
       {
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() != 1)
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() != 1)
             return;
-      QGraphicsItem* item = items[0];
-      Note* note = (Note*)item->data(0).value<void*>();
+      Note* note = notes[0];
       if (note == 0)
             return;
       ValueType vt = note->veloType();
@@ -396,16 +386,11 @@ void DrumrollEditor::cmd(QAction* a)
       {
       score()->startCmd();
       if (a->data() == "delete") {
-            QList<QGraphicsItem*> items = gv->items();
-            foreach(QGraphicsItem* item, items) {
-                  Note* note = static_cast<Note*>(item->data(0).value<void*>());
-                  if (note) {
-                        score()->deleteItem(note);
-                        }
-                  }
+            foreach(Note* note, gv->selectedNotes())
+                  score()->deleteItem(note);
             }
 
-      gv->setStaff(staff, locator);
+      gv->updateNotes();
       score()->endCmd();
       }
 
@@ -50,10 +50,9 @@ static int pitch2y(int pitch)
 //---------------------------------------------------------
 
 DrumItem::DrumItem(Note* n)
-   : QGraphicsPolygonItem(), note(n)
+   : QGraphicsPolygonItem(), _note(n)
       {
       setFlags(flags() | QGraphicsItem::ItemIsSelectable);
-      int pitch = n->pitch();
       QPolygonF p;
       double h2 = keyHeight/2;
       p << QPointF(0, -h2) << QPointF(h2, 0.0) << QPointF(0.0, h2) << QPointF(-h2, 0.0);
@@ -61,11 +60,19 @@ DrumItem::DrumItem(Note* n)
       setBrush(QBrush());
       setSelected(n->selected());
       setData(0, QVariant::fromValue<void*>(n));
-
-      setPos(n->chord()->tick() + 480, pitch2y(pitch) + keyHeight / 4);
+      updateValues();
       setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
       }
 
+//---------------------------------------------------------
+//   updateValues
+//---------------------------------------------------------
+
+void DrumItem::updateValues()
+      {
+      setPos(_note->chord()->tick() + 480, pitch2y(_note->pitch()) + keyHeight / 4);
+      }
+
 //---------------------------------------------------------
 //   paint
 //---------------------------------------------------------
@@ -73,7 +80,7 @@ DrumItem::DrumItem(Note* n)
 void DrumItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*)
       {
 //      Chord* chord = note->chord();
-      int x1       = note->onTimeOffset() + note->onTimeUserOffset();
+      int x1       = _note->onTimeOffset() + _note->onTimeUserOffset();
       painter->setPen(pen());
       painter->setBrush(isSelected() ? Qt::yellow : Qt::blue);
       painter->drawPolygon(polygon().translated(x1, 0.0));
@@ -251,6 +258,7 @@ DrumView::DrumView()
       setDragMode(QGraphicsView::RubberBandDrag);
       _timeType = TICKS;
       magStep   = 0;
+      staff     = 0;
       }
 
 //---------------------------------------------------------
@@ -267,6 +275,7 @@ void DrumView::setStaff(Staff* s, Pos* l)
 
       scene()->blockSignals(true);
 
+      visibleItems.clear();
       scene()->clear();
       for (int i = 0; i < 3; ++i) {
             locatorLines[i] = new QGraphicsLineItem(QLineF(0.0, 0.0, 0.0, keyHeight * 75.0 * 5));
@@ -277,7 +286,32 @@ void DrumView::setStaff(Staff* s, Pos* l)
             locatorLines[i]->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
             scene()->addItem(locatorLines[i]);
             }
+      scene()->blockSignals(false);
+      buildIndex();
+
+      Measure* lm = staff->score()->lastMeasure();
+      ticks       = lm->tick() + lm->ticks();
+      scene()->setSceneRect(0.0, 0.0, double(ticks + 960), keyHeight * 75);
+
+      for (int i = 0; i < 3; ++i)
+            moveLocator(i);
+      //
+      // move to something interesting
+      //
+      QRectF boundingRect;
+      foreach(Note* note, index.selectedNotes())
+            boundingRect |= QRectF(note->chord()->tick() + MAP_OFFSET, pitch2y(note->pitch()), 1.0, keyHeight / 2);
+      centerOn(boundingRect.center());
+      updateItems();
+      }
 
+//---------------------------------------------------------
+//   buildIndex
+//---------------------------------------------------------
+
+void DrumView::buildIndex()
+      {
+      index.clear();
       int staffIdx = staff->idx();
       int startTrack = staffIdx * VOICES;
       int endTrack   = startTrack + VOICES;
@@ -290,29 +324,109 @@ void DrumView::setStaff(Staff* s, Pos* l)
                   foreach(Note* n, chord->notes()) {
                         if (n->tieBack())
                               continue;
-                        scene()->addItem(new DrumItem(n));
+                        index.append(n->pitch(), chord->tick(), 0, n);
                         }
                   }
             }
+      }
+
+//---------------------------------------------------------
+//   updateItems
+//    create graphics items only for the notes in the
+//    visible area (plus one screen to the left and right)
+//---------------------------------------------------------
+
+void DrumView::updateItems()
+      {
+      if (staff == 0)
+            return;
+      QRectF r = mapToScene(viewport()->rect()).boundingRect();
+      qreal w  = r.width();
+      r.adjust(-w, -keyHeight, w, keyHeight);
+      int tick1 = int(r.left()) - MAP_OFFSET;
+      int tick2 = int(r.right()) - MAP_OFFSET;
+
+      QList<NoteIndexEntry> nl;
+      for (int pitch = 0; pitch < 128; ++pitch) {
+            int y = pitch2y(pitch);
+            if (y < r.top() || y > r.bottom())
+                  continue;
+            index.find(pitch, tick1, tick2, &nl);
+            }
+
+      scene()->blockSignals(true);
+      QHash<Note*, DrumItem*> items;
+      foreach(const NoteIndexEntry& e, nl) {
+            DrumItem* item = visibleItems.take(e.note);
+            if (item)
+                  item->updateValues();
+            else {
+                  item = new DrumItem(e.note);
+                  scene()->addItem(item);
+                  }
+            items.insert(e.note, item);
+            }
+      foreach(DrumItem* item, visibleItems)
+            delete item;
+      visibleItems = items;
       scene()->blockSignals(false);
+      }
 
+//---------------------------------------------------------
+//   updateNotes
+//    called after the score was edited
+//---------------------------------------------------------
+
+void DrumView::updateNotes()
+      {
+      if (staff == 0)
+            return;
+      buildIndex();
       Measure* lm = staff->score()->lastMeasure();
       ticks       = lm->tick() + lm->ticks();
       scene()->setSceneRect(0.0, 0.0, double(ticks + 960), keyHeight * 75);
+      updateItems();
+      }
 
-      for (int i = 0; i < 3; ++i)
-            moveLocator(i);
-      //
-      // move to something interesting
-      //
-      QList<QGraphicsItem*> items = scene()->selectedItems();
-      QRectF boundingRect;
-      foreach(QGraphicsItem* item, items) {
-            Note* note = static_cast<Note*>(item->data(0).value<void*>());
-            if (note)
-                  boundingRect |= item->mapToScene(item->boundingRect()).boundingRect();
+//---------------------------------------------------------
+//   selectedNotes
+//    selected notes of the visible items plus notes
+//    outside the visible area which are selected in
+//    the score
+//---------------------------------------------------------
+
+QList<Note*> DrumView::selectedNotes() const
+      {
+      QList<Note*> nl;
+      foreach(DrumItem* item, visibleItems) {
+            if (item->isSelected())
+                  nl.append(item->note());
             }
-      centerOn(boundingRect.center());
+      foreach(Note* note, index.selectedNotes()) {
+            if (!visibleItems.contains(note))
+                  nl.append(note);
+            }
+      return nl;
+      }
+
+//---------------------------------------------------------
+//   scrollContentsBy
+//---------------------------------------------------------
+
+void DrumView::scrollContentsBy(int dx, int dy)
+      {
+      QGraphicsView::scrollContentsBy(dx, dy);
+      updateItems();
+      }
+
+//---------------------------------------------------------
+//   resizeEvent
+//---------------------------------------------------------
+
+void DrumView::resizeEvent(QResizeEvent* event)
+      {
+      QGraphicsView::resizeEvent(event);
+      updateItems();
       }
 
 //---------------------------------------------------------
@@ -392,6 +506,7 @@ void DrumView::wheelEvent(QWheelEvent* event)
             double xpos = -(mapFromScene(QPointF()).x());
             if (xpos <= 0)
                   emit xposChanged(xpos);
+            updateItems();
             }
       else if (event->modifiers() == Qt::ShiftModifier) {
             QWheelEvent we(event->pos(), event->delta(), event->buttons(), 0, Qt::Horizontal);
@@ -418,6 +533,7 @@ void DrumView::wheelEvent(QWheelEvent* event)
                         }
                   }
             emit magChanged(xmag, ymag);
+            updateItems();
             }
       }
 
@@ -451,6 +567,32 @@ int DrumView::y2pitch(int y) const
       return pitch;
       }
 
+//---------------------------------------------------------
+//   mousePressEvent
+//    a click without Ctrl starts a new selection; notes
+//    which are selected but have no item because they are
+//    scrolled out of view cannot be deselected by the
+//    scene, so drop them here
+//---------------------------------------------------------
+
+void DrumView::mousePressEvent(QMouseEvent* event)
+      {
+      if (!(event->modifiers() & Qt::ControlModifier)) {
+            Score* score = 0;
+            foreach(Note* note, index.selectedNotes()) {
+                  if (visibleItems.contains(note))
+                        continue;
+                  score = note->score();
+                  score->deselect(note);
+                  }
+            if (score) {
+                  score->setUpdateAll();
+                  score->end();
+                  }
+            }
+      QGraphicsView::mousePressEvent(event);
+      }
+
 //---------------------------------------------------------
 //   mouseMoveEvent
 //---------------------------------------------------------
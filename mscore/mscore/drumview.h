@@ -22,6 +22,7 @@
 #define __DRUMVIEW_H__
 
 #include "libmscore/pos.h"
+#include "pianoview.h"
 
 class Staff;
 class Score;
@@ -32,12 +33,14 @@ class Note;
 //---------------------------------------------------------
 
 class DrumItem : public QGraphicsPolygonItem {
-      Note* note;
+      Note* _note;
 
       virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0);
 
    public:
       DrumItem(Note*);
+      Note* note() const { return _note; }
+      void updateValues();
       };
 
 //---------------------------------------------------------
@@ -54,8 +57,12 @@ class DrumView : public QGraphicsView {
       int ticks;
       TType _timeType;
       int magStep;
+      NoteIndex index;
+      QHash<Note*, DrumItem*> visibleItems;
 
       virtual void drawBackground(QPainter* painter, const QRectF& rect);
+      void buildIndex();
+      void updateItems();
 
       int y2pitch(int y) const;
       Pos pix2pos(int x) const;
@@ -63,8 +70,11 @@ class DrumView : public QGraphicsView {
 
    protected:
       virtual void wheelEvent(QWheelEvent* event);
+      virtual void mousePressEvent(QMouseEvent* event);
       virtual void mouseMoveEvent(QMouseEvent* event);
       virtual void leaveEvent(QEvent*);
+      virtual void scrollContentsBy(int dx, int dy);
+      virtual void resizeEvent(QResizeEvent*);
 
    signals:
       void magChanged(double, double);
@@ -78,8 +88,9 @@ class DrumView : public QGraphicsView {
    public:
       DrumView();
       void setStaff(Staff*, Pos* locator);
+      void updateNotes();
       void ensureVisible(int tick);
-      QList<QGraphicsItem*> items() { return scene()->selectedItems(); }
+      QList<Note*> selectedNotes() const;
       };
 
 
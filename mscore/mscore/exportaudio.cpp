@@ -24,6 +24,8 @@
 
 #include <sndfile.h>
 #include "libmscore/score.h"
+#include "libmscore/dsp.h"
+#include "libmscore/eventframes.h"
 #include "fluid.h"
 // #include "libmscore/tempo.h"
 #include "libmscore/note.h"
@@ -58,6 +60,8 @@ bool MuseScore::saveAudio(Score* score, const QString& name, const QString& ext)
 
       EventMap events;
       score->toEList(&events);
+      EventFrames eventFrames;
+      eventFrames.init(score, events.keys());
 
       SF_INFO info;
       memset(&info, 0, sizeof(info));
@@ -78,11 +82,12 @@ bool MuseScore::saveAudio(Score* score, const QString& name, const QString& ext)
       double gain = 1.0;
       EventMap::const_iterator endPos = events.constEnd();
       --endPos;
-      const int et = (score->utick2utime(endPos.key()) + 1) * MScore::sampleRate;
+      const qint64 et = qRound64((score->utick2utime(endPos.key()) + 1) * MScore::sampleRate);
       for (int pass = 0; pass < 2; ++pass) {
             EventMap::const_iterator playPos;
             playPos = events.constBegin();
-            pBar->setRange(0, et);
+            int playIdx = 0;
+            pBar->setRange(0, int(et));
 
             //
             // init instruments
@@ -102,7 +107,7 @@ bool MuseScore::saveAudio(Score* score, const QString& name, const QString& ext)
 
             static const unsigned FRAMES = 512;
             float buffer[FRAMES * 2];
-            int playTime = 0;
+            qint64 playTime = 0;
             synti->setGain(gain);
 
             for (;;) {
@@ -111,11 +116,11 @@ bool MuseScore::saveAudio(Score* score, const QString& name, const QString& ext)
                   // collect events for one segment
                   //
                   memset(buffer, 0, sizeof(float) * FRAMES * 2);
-                  int endTime = playTime + frames;
+                  qint64 endTime = playTime + frames;
                   float* l = buffer;
                   float* r = buffer + FRAMES;
-                  for (; playPos != events.constEnd(); ++playPos) {
-                        int f = score->utick2utime(playPos.key()) * MScore::sampleRate;
+                  for (; playPos != events.constEnd(); ++playPos, ++playIdx) {
+                        qint64 f = eventFrames.frame(playIdx);
                         if (f >= endTime)
                               break;
                         int n = f - playTime;
@@ -140,23 +145,13 @@ bool MuseScore::saveAudio(Score* score, const QString& name, const QString& ext)
                         }
                   if (pass == 1) {
                         float b[FRAMES * 2];
-                        float* dp = b;
-                        float* spl = buffer;
-                        float* spr = buffer + FRAMES;
-                        for (unsigned i = 0; i < FRAMES; ++i) {
-                              *dp++ = *spl++;
-                              *dp++ = *spr++;
-                              }
+                        dsp->interleave(b, buffer, buffer + FRAMES, FRAMES);
                         sf_writef_float(sf, b, FRAMES);
                         }
-                  else {
-                        for (unsigned i = 0; i < FRAMES * 2; ++i) {
-                              if (qAbs(buffer[i]) > peak)
-                                    peak = qAbs(buffer[i]);
-                              }
-                        }
+                  else
+                        peak = dsp->peak(buffer, FRAMES * 2, peak);
                   playTime = endTime;
-                  pBar->setValue(playTime);
+                  pBar->setValue(int(playTime));
                   if (playTime >= et)
                         break;
                   }
@@ -4176,6 +4176,7 @@ foreach(Element* el, *(score->gel())) {
             }
 
       xml.etag();
+      xml.flush();
       }
 
 //---------------------------------------------------------
@@ -4191,6 +4192,7 @@ foreach(Element* el, *(score->gel())) {
 
 bool MuseScore::saveXml(Score* score, const QString& name)
       {
+      score->doPendingLayout();
       QFile f(name);
       if (!f.open(QIODevice::WriteOnly))
             return false;
@@ -4223,6 +4225,8 @@ bool MuseScore::saveMxl(Score* score, const QString& name)
       {
 //      printf("Score::saveMxl(%s)\n", name.toUtf8().data());
 
+      score->doPendingLayout();
+
       Zip uz;
       if (!uz.createArchive(name)) {
             printf("Cannot create zipfile %s\n", qPrintable(name + ": " + uz.errorString()));
@@ -4248,22 +4252,25 @@ bool MuseScore::saveMxl(Score* score, const QString& name)
       xml.etag();
       xml.etag();
       xml.etag();
+      xml.flush();
 //      printf("bufsize=%d\n", cbuf.data().size());
 //      printf("data=%s\n", cbuf.data().data());
-      cbuf.seek(0);
-      if (!uz.createEntry("META-INF/container.xml", cbuf, dt)) {
+      if (!uz.createEntry(ZipData("META-INF/container.xml", cbuf.data()), dt)) {
             printf("Cannot add container.xml to zipfile '%s'\n", qPrintable(name + ": " + uz.errorString()));
             return false;
             }
 
-      QBuffer dbuf;
-      dbuf.open(QIODevice::ReadWrite);
+      // stream the score straight into the archive
+      if (!uz.beginEntry(fn, dt)) {
+            printf("Cannot add %s to zipfile '%s'\n", qPrintable(fn), qPrintable(name));
+            return false;
+            }
+      ZipEntryDevice dbuf(&uz);
+      dbuf.open(QIODevice::WriteOnly);
       ExportMusicXml em(score);
       em.write(&dbuf);
-//      printf("bufsize=%d\n", dbuf.data().size());
-//      printf("data=%s\n", dbuf.data().data());
-      dbuf.seek(0);
-      if (!uz.createEntry(fn, dbuf, dt)) {
+      dbuf.close();
+      if (!uz.endEntry()) {
             printf("Cannot add %s to zipfile '%s'\n", qPrintable(fn), qPrintable(name));
             return false;
             }
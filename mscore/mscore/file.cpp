@@ -285,6 +285,7 @@ void MuseScore::saveFile()
             tab2->setTabText(idx, cs->name());
       QString tmp = cs->tmpName();
       if (!tmp.isEmpty()) {
+            autoSaveWatcher.waitForFinished();
             QFile f(tmp);
             if (!f.remove())
                   printf("cannot remove temporary file <%s>\n", qPrintable(f.fileName()));
@@ -1146,6 +1147,7 @@ QString MuseScore::getDrumsetFilename(bool open)
 
 void MuseScore::printFile()
       {
+      cs->doPendingLayout();
       QPrinter printerDev(QPrinter::HighResolution);
       PageFormat* pf = cs->pageFormat();
 
@@ -1373,6 +1375,7 @@ bool MuseScore::saveAs(Score* cs, bool saveCopy, const QString& path, const QStr
 
 bool MuseScore::savePsPdf(const QString& saveName, QPrinter::OutputFormat format)
       {
+      cs->doPendingLayout();
       PageFormat* pf = cs->pageFormat();
       QPrinter printerDev(QPrinter::HighResolution);
 
@@ -1725,6 +1728,7 @@ void MuseScore::addImage(Score* score, Element* e)
 
 bool MuseScore::saveSvg(Score* score, const QString& saveName)
       {
+      score->doPendingLayout();
       QSvgGenerator printer;
       printer.setResolution(int(DPI));
       printer.setFileName(saveName);
@@ -1795,6 +1799,7 @@ bool MuseScore::savePng(Score* score, const QString& name)
 bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool transparent, double convDpi, QImage::Format format)
       {
       bool rv = true;
+      score->doPendingLayout();
       score->setPrinting(!screenshot);    // dont print page break symbols etc.
 
       QImage::Format f;
@@ -0,0 +1,127 @@
+//=============================================================================
+//  MuseScore
+//  Linux Music Score Editor
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//=============================================================================
+
+#include "config.h"
+#include "fileaudio.h"
+#include "libmscore/mscore.h"
+#include "libmscore/dsp.h"
+
+#ifdef HAS_AUDIOFILE
+
+//---------------------------------------------------------
+//   FileAudio
+//---------------------------------------------------------
+
+FileAudio::FileAudio(Seq* s)
+   : Driver(s)
+      {
+      state = Seq::TRANSPORT_STOP;
+      sf    = 0;
+      }
+
+FileAudio::~FileAudio()
+      {
+      if (sf)
+            sf_close(sf);
+      }
+
+//---------------------------------------------------------
+//   sampleRate
+//---------------------------------------------------------
+
+int FileAudio::sampleRate() const
+      {
+      return MScore::sampleRate;
+      }
+
+//---------------------------------------------------------
+//   open
+//    the format is given by the file extension
+//---------------------------------------------------------
+
+bool FileAudio::open(const QString& path)
+      {
+      SF_INFO info;
+      memset(&info, 0, sizeof(info));
+      info.channels   = 2;
+      info.samplerate = MScore::sampleRate;
+      if (path.endsWith(".flac"))
+            info.format = SF_FORMAT_FLAC | SF_FORMAT_PCM_16;
+      else if (path.endsWith(".wav"))
+            info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+      else {
+            fprintf(stderr, "unknown audio file type <%s>\n", qPrintable(path));
+            return false;
+            }
+      sf = sf_open(qPrintable(path), SFM_WRITE, &info);
+      if (sf == 0) {
+            fprintf(stderr, "open soundfile failed: %s\n", sf_strerror(sf));
+            return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   render
+//    Run the sequencer until it stops the transport at the
+//    end of the score. The period sizes change from call
+//    to call, as they may with a real driver, so that any
+//    error in the play position accumulates.
+//---------------------------------------------------------
+
+bool FileAudio::render()
+      {
+      static const unsigned periods[] = { 64, 441, 1000, 1023, 4096, 127 };
+      static const int nperiods = sizeof(periods) / sizeof(*periods);
+      static const unsigned MAX_PERIOD = 4096;
+
+      float l[MAX_PERIOD];
+      float r[MAX_PERIOD];
+      float buffer[MAX_PERIOD * 2];
+
+      bool played = false;
+      for (int i = 0;; ++i) {
+            unsigned n = periods[i % nperiods];
+            seq->process(n, l, r);
+            if (seq->isPlaying())
+                  played = true;
+            else if (played)
+                  break;
+            else if (i > nperiods) {
+                  fprintf(stderr, "sequencer did not start\n");
+                  return false;
+                  }
+            dsp->interleave(buffer, l, r, n);
+            if (sf_writef_float(sf, buffer, n) != sf_count_t(n)) {
+                  fprintf(stderr, "write soundfile failed: %s\n", sf_strerror(sf));
+                  return false;
+                  }
+            }
+      if (sf_close(sf)) {
+            sf = 0;
+            fprintf(stderr, "close soundfile failed\n");
+            return false;
+            }
+      sf = 0;
+      return true;
+      }
+
+#endif
+
@@ -0,0 +1,64 @@
+//=============================================================================
+//  MuseScore
+//  Linux Music Score Editor
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//=============================================================================
+
+#ifndef __FILEAUDIO_H__
+#define __FILEAUDIO_H__
+
+#include "config.h"
+#include "driver.h"
+#include "seq.h"
+
+#ifdef HAS_AUDIOFILE
+
+#include <sndfile.h>
+
+//---------------------------------------------------------
+//   FileAudio
+//    offline audio driver: calls Seq::process() as fast as
+//    possible with changing period sizes and writes the
+//    output to a sound file. Used by the converter (-P) to
+//    check the timing of the sequencer itself.
+//---------------------------------------------------------
+
+class FileAudio : public Driver {
+      int state;
+      SNDFILE* sf;
+
+   public:
+      FileAudio(Seq*);
+      virtual ~FileAudio();
+      virtual bool init()                   { return true; }
+      virtual bool start()                  { return true; }
+      virtual bool stop()                   { return true; }
+      virtual QList<QString> inputPorts()   { return QList<QString>(); }
+      virtual void stopTransport()          { state = Seq::TRANSPORT_STOP; }
+      virtual void startTransport()         { state = Seq::TRANSPORT_PLAY; }
+      virtual int getState()                { return state; }
+      virtual int sampleRate() const;
+      virtual void registerPort(const QString&, bool, bool) {}
+      virtual void unregisterPort(int)      {}
+
+      bool open(const QString& path);
+      bool render();
+      };
+
+#endif
+#endif
+
@@ -742,6 +742,16 @@ void MidiFile::processMeta(Score* cs, MidiTrack* track, const Event& mm)
             }
       }
 
+//---------------------------------------------------------
+//   cleanupTrack
+//---------------------------------------------------------
+
+static void cleanupTrack(MidiTrack*& midiTrack)
+      {
+      if (midiTrack->staffIdx() != -1)
+            midiTrack->cleanup();   // quantize
+      }
+
 //---------------------------------------------------------
 //   convertMidi
 //---------------------------------------------------------
@@ -936,11 +946,12 @@ void MuseScore::convertMidi(Score* score, MidiFile* mf)
             }
       score->fixTicks();
 
-	foreach (MidiTrack* midiTrack, *tracks) {
-            if (midiTrack->staffIdx() == -1)
-                  continue;
-            midiTrack->cleanup();   // quantize
-            }
+      //---------------------------------------------------
+      //  quantize; tracks are independent and can be
+      //  processed in parallel
+      //---------------------------------------------------
+
+      QtConcurrent::blockingMap(*tracks, cleanupTrack);
 
       //---------------------------------------------------
       //  process meta events
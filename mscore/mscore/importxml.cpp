@@ -231,9 +231,10 @@ static void moveTick(int& tick, int& maxtick, int& lastLen, int divisions, QDomE
  MusicXml constructor.
  */
 
-MusicXml::MusicXml(QDomDocument* d)
+MusicXml::MusicXml(QDomDocument* d, const QByteArray& ba)
       {
       doc = d;
+      data = ba;
       maxLyrics = 0;
       lastVolta = 0;
       beamMode = BEAM_NO;
@@ -249,6 +250,7 @@ MusicXml::MusicXml(QDomDocument* d)
 
 class LoadMusicXml : public LoadFile {
       QDomDocument* _doc;
+      QByteArray _data;
 
    public:
       LoadMusicXml() {
@@ -259,6 +261,7 @@ class LoadMusicXml : public LoadFile {
             }
       virtual bool loader(QFile* f);
       QDomDocument* doc() const { return _doc; }
+      QByteArray takeData() { QByteArray d(_data); _data = QByteArray(); return d; }
       };
 
 //---------------------------------------------------------
@@ -273,7 +276,8 @@ bool LoadMusicXml::loader(QFile* qf)
       {
       int line, column;
       QString err;
-      if (!_doc->setContent(qf, false, &err, &line, &column)) {
+      _data = qf->readAll();
+      if (!_doc->setContent(_data, false, &err, &line, &column)) {
             QString col, ln;
             col.setNum(column);
             ln.setNum(line);
@@ -294,6 +298,7 @@ bool LoadMusicXml::loader(QFile* qf)
 
 class LoadCompressedMusicXml : public LoadFile {
       QDomDocument* _doc;
+      QByteArray _data;
 
    public:
       LoadCompressedMusicXml() {
@@ -304,6 +309,7 @@ class LoadCompressedMusicXml : public LoadFile {
             }
       virtual bool loader(QFile* f);
       QDomDocument* doc() const { return _doc; }
+      QByteArray takeData() { QByteArray d(_data); _data = QByteArray(); return d; }
       };
 
 //---------------------------------------------------------
@@ -372,14 +378,12 @@ bool LoadCompressedMusicXml::loader(QFile* qf)
 // else
 //   printf("rootfile=%s\n", rootfile.toUtf8().data());
 
-      QBuffer dbuf;
-      dbuf.open(QIODevice::WriteOnly);
-      uz.extractFile(rootfile, &dbuf);
-// printf("bufsize=%d\n", dbuf.data().size());
-// printf("data=%s\n", dbuf.data().data());
+      _data = uz.fileData(rootfile);
+// printf("bufsize=%d\n", _data.size());
+// printf("data=%s\n", _data.data());
 // printf("data end\n");
 
-      if (!_doc->setContent(dbuf.data(), false, &err, &line, &column)) {
+      if (!_doc->setContent(_data, false, &err, &line, &column)) {
             QString col, ln;
             col.setNum(column);
             ln.setNum(line);
@@ -406,9 +410,8 @@ bool MuseScore::importMusicXml(Score* score, const QString& name)
       LoadMusicXml lx;
       if (!lx.load(name))
             return false;
-      MusicXml musicxml(lx.doc());
-      musicxml.import(score);
-      return true;
+      MusicXml musicxml(lx.doc(), lx.takeData());
+      return musicxml.import(score);
       }
 
 //---------------------------------------------------------
@@ -425,9 +428,8 @@ bool MuseScore::importCompressedMusicXml(Score* score, const QString& name)
       LoadCompressedMusicXml lx;
       if (!lx.load(name))
             return false;
-      MusicXml musicxml(lx.doc());
-      musicxml.import(score);
-      return true;
+      MusicXml musicxml(lx.doc(), lx.takeData());
+      return musicxml.import(score);
       }
 
 //---------------------------------------------------------
@@ -443,7 +445,7 @@ bool MuseScore::importCompressedMusicXml(Score* score, const QString& name)
  Parse the MusicXML file, which must be in score-partwise format.
  */
 
-void MusicXml::import(Score* s)
+bool MusicXml::import(Score* s)
       {
       score  = s;
       tie    = 0;
@@ -462,12 +464,29 @@ void MusicXml::import(Score* s)
       // TODO only if multi-measure rests used ???
       score->style()->set(ST_createMultiMeasureRests, true);
 
+      //
+      // the stream reader is stricter than QDomDocument (e.g. about
+      // entities declared in the DOCTYPE); if it fails, scan the
+      // document as serialized from the dom tree
+      //
+      bool ok = prescan(data);
+      data = QByteArray();          // the raw document is not needed any more
+      if (!ok) {
+            printf("MusicXml-Import: prescan of the raw document failed, using the dom tree\n");
+            ok = prescan(doc->toByteArray());
+            }
+      if (!ok) {
+            printf("MusicXml-Import: prescan failed\n");
+            return false;
+            }
+
       for (QDomElement e = doc->documentElement(); !e.isNull(); e = e.nextSiblingElement()) {
             if (e.tagName() == "score-partwise")
                   scorePartwise(e.firstChildElement());
             else
                   domError(e);
             }
+      return true;
       }
 
 //---------------------------------------------------------
@@ -622,92 +641,193 @@ void MusicXml::doCredits()
 
 
 //---------------------------------------------------------
-//   determineMeasureLength
+//   prescanNote
 //---------------------------------------------------------
 
 /**
- Determine the length in ticks of each measure in part e
+ Pre-scan a note: move tick and count the chordrests per voice and staff.
  */
 
-static void determineMeasureLength(QDomElement e, QVector<int>& ml)
+static void prescanNote(QXmlStreamReader& r, int divisions, int& tick, int& maxtick, int& lastLen,
+   QMap<int, VoiceDesc>& voicelist)
       {
-      // debug
-      printf("measurelength ml size %d\n", ml.size());
-      int divisions = 0;
-      int tick = 0;
-      int maxtick = 0;
+      bool chord = false;
+      bool grace = false;
+      int ticks  = 0;
+      int voice  = -1;
+      int staff  = -1;
+      while (r.readNextStartElement()) {
+            if (r.name() == "chord") {
+                  chord = true;
+                  r.skipCurrentElement();
+                  }
+            else if (r.name() == "grace") {
+                  grace = true;
+                  r.skipCurrentElement();
+                  }
+            else if (r.name() == "duration")
+                  ticks = calcTicks(r.readElementText(), divisions);
+            else if (r.name() == "voice")
+                  voice = r.readElementText().toInt() - 1;
+            else if (r.name() == "staff")
+                  staff = r.readElementText().toInt() - 1;
+            else
+                  r.skipCurrentElement();
+            }
+      if (!grace) {
+            if (chord)
+                  // LVIFIX: use of lastLen for chord handling is abit of a hack
+                  // TODO: replace by more elegant mechanism
+                  tick -= lastLen;
+            lastLen = ticks; // ?
+            tick += ticks;
+            if (tick > maxtick)
+                  maxtick = tick;
+            }
+      // set correct defaults for missing elements
+      if (voice == -1)
+            voice = 0;
+      if (staff == -1)
+            staff = 0;
+      // count the chords (only the first note in a chord is counted)
+      if (!chord && 0 <= staff && staff < MAX_STAVES) {
+            if (!voicelist.contains(voice))
+                  voicelist.insert(voice, VoiceDesc());
+            voicelist[voice].incrChordRests(staff);
+            }
+      }
+
+//---------------------------------------------------------
+//   prescanDuration
+//---------------------------------------------------------
+
+/**
+ Read the duration of a forward or backup element.
+ */
+
+static int prescanDuration(QXmlStreamReader& r, int divisions)
+      {
+      int val = 0;
+      while (r.readNextStartElement()) {
+            if (r.name() == "duration")
+                  val = calcTicks(r.readElementText(), divisions);
+            else
+                  r.skipCurrentElement();
+            }
+      return val;
+      }
+
+//---------------------------------------------------------
+//   prescanPart
+//---------------------------------------------------------
+
+/**
+ Determine the length in ticks of each measure in a part
+ and the number of chordrests per voice and staff.
+ */
+
+static void prescanPart(QXmlStreamReader& r, MusicXmlPartDesc& pd)
+      {
+      int divisions   = 0;
+      int tick        = 0;
+      int maxtick     = 0;
       int prevmaxtick = 0;
-      int lastLen = 0;
-      int measureNr = 0;
-      for (e = e.firstChildElement(); !e.isNull(); e = e.nextSiblingElement()) {
-            // handle all measures in this part
-            if (e.tagName() == "measure") {
-                  for (QDomElement ee = e.firstChildElement(); !ee.isNull(); ee = ee.nextSiblingElement()) {
-                        if (ee.tagName() == "attributes") {
-                              for (QDomElement eee = ee.firstChildElement(); !eee.isNull(); eee = eee.nextSiblingElement()) {
-                                    if (eee.tagName() == "divisions") {
-                                          bool ok;
-                                          divisions = stringToInt(eee.text(), &ok);
-                                          if (!ok) {
-                                                printf("MusicXml-Import: bad divisions value: <%s>\n",
-                                                   qPrintable(eee.text()));
-                                                      divisions = 4;
-                                                }
-                                          // debug
-                                          printf("measurelength divisions %d\n", divisions);
-                                          }
-                                    }
-                              }
-                        else if (ee.tagName() == "note") {
-                              bool chord = false;
-                              bool grace = false;
-                              for (QDomElement eee = ee.firstChildElement(); !eee.isNull(); eee = eee.nextSiblingElement()) {
-                                    if (eee.tagName() == "chord") {
-                                          chord = true;
-                                          }
-                                    else if (eee.tagName() == "grace") {
-                                          grace = true;
+      int lastLen     = 0;
+      while (r.readNextStartElement()) {
+            if (r.name() != "measure") {
+                  r.skipCurrentElement();
+                  continue;
+                  }
+            while (r.readNextStartElement()) {
+                  if (r.name() == "attributes") {
+                        while (r.readNextStartElement()) {
+                              if (r.name() == "divisions") {
+                                    QString s(r.readElementText());
+                                    bool ok;
+                                    divisions = stringToInt(s, &ok);
+                                    if (!ok) {
+                                          printf("MusicXml-Import: bad divisions value: <%s>\n",
+                                             qPrintable(s));
+                                          divisions = 4;
                                           }
                                     }
-                              if (chord && !grace)
-                                    // LVIFIX: use of lastLen for chord handling is abit of a hack
-                                    // TODO: replace by more elegant mechanism
-                                    tick -= lastLen;
-                              moveTick(tick, maxtick, lastLen, divisions, ee);
-                              }
-                        else if (ee.tagName() == "backup") {
-                              moveTick(tick, maxtick, lastLen, divisions, ee);
-                              }
-                        else if (ee.tagName() == "forward") {
-                              moveTick(tick, maxtick, lastLen, divisions, ee);
+                              else
+                                    r.skipCurrentElement();
                               }
                         }
-                  // determine length of this measure
-                  int length = maxtick - prevmaxtick;
-                  // debug
-                  printf("measurelength measure %d tick %d maxtick %d length %d\n",
-                         measureNr + 1, tick, maxtick, length);
-                  // store the maximum measure length
-                  if (ml.size() < measureNr + 1)
-                        // as we loop over the measures one by one
-                        // if size of ml is too small, it will be one element short
-                        ml.append(length);
-                  else {
-                        // check if measure contains more ticks in this part
-                        // than in previous parts and if so update length
-                        if (length > ml.at(measureNr))
-                              ml[measureNr] = length;
+                  else if (r.name() == "note")
+                        prescanNote(r, divisions, tick, maxtick, lastLen, pd.voicelist);
+                  else if (r.name() == "backup") {
+                        lastLen = prescanDuration(r, divisions);
+                        tick -= lastLen;
                         }
-                  // prepare for next measure
-                  prevmaxtick = maxtick;
-                  tick = maxtick;
-                  measureNr++;
+                  else if (r.name() == "forward") {
+                        lastLen = prescanDuration(r, divisions);
+                        tick += lastLen;
+                        if (tick > maxtick)
+                              maxtick = tick;
+                        }
+                  else
+                        r.skipCurrentElement();
                   }
+            // determine length of this measure
+            pd.measureLength.append(maxtick - prevmaxtick);
+            // prepare for next measure
+            prevmaxtick = maxtick;
+            tick = maxtick;
             }
-      // debug
-      printf("measurelength ml size %d\n", ml.size());
-      for (int i = 0; i < ml.size(); i++)
-            printf("measurelength ml[%d] %d\n", i + 1, ml.at(i));
+      }
+
+//---------------------------------------------------------
+//   prescan
+//---------------------------------------------------------
+
+/**
+ Scan the document \a ba once with a stream reader to collect the
+ measure lengths and voice usage of all parts, instead of walking
+ the DOM tree of every part several times.
+ Return false on a parse error.
+ */
+
+bool MusicXml::prescan(const QByteArray& ba)
+      {
+      partDescs.clear();
+      measureLength.clear();
+      QXmlStreamReader r(ba);
+      while (r.readNextStartElement()) {
+            if (r.name() != "score-partwise") {
+                  r.skipCurrentElement();
+                  continue;
+                  }
+            while (r.readNextStartElement()) {
+                  if (r.name() == "part") {
+                        MusicXmlPartDesc pd;
+                        pd.id = r.attributes().value("id").toString();
+                        prescanPart(r, pd);
+                        partDescs.append(pd);
+                        }
+                  else
+                        r.skipCurrentElement();
+                  }
+            }
+      if (r.hasError()) {
+            printf("MusicXml-Import: prescan: %s at line %lld\n",
+               qPrintable(r.errorString()), r.lineNumber());
+            partDescs.clear();
+            return false;
+            }
+
+      // store the maximum length of each measure over all parts
+      foreach(const MusicXmlPartDesc& pd, partDescs) {
+            for (int i = 0; i < pd.measureLength.size(); ++i) {
+                  int length = pd.measureLength.at(i);
+                  if (i >= measureLength.size())
+                        measureLength.append(length);
+                  else if (length > measureLength.at(i))
+                        measureLength[i] = length;
+                  }
+            }
+      return true;
       }
 
 
@@ -724,6 +844,8 @@ static void determineMeasureLength(QDomElement e, QVector<int>& ml)
 static void determineMeasureStart(const QVector<int>& ml, QVector<int>& ms)
       {
       ms.resize(ml.size());
+      if (ms.isEmpty())
+            return;
       // first measure starts at tick = 0
       ms[0] = 0;
       // all others start at start tick previous measure plus length previous measure
@@ -748,7 +870,7 @@ void MusicXml::scorePartwise(QDomElement ee)
       // In a first pass collect all Parts in case the part-list does not
       // list them all. Incomplete part-list's are generated by some versions
       // of finale
-      // Furthermore, determine the length in ticks of each measure in the part
+      // The length in ticks of each measure was determined by prescan()
 
       for (QDomElement e = ee; !e.isNull(); e = e.nextSiblingElement()) {
             if (e.tagName() == "part") {
@@ -759,8 +881,6 @@ void MusicXml::scorePartwise(QDomElement ee)
                   Staff* staff = new Staff(score, part, 0);
                   part->staves()->push_back(staff);
                   score->staves().push_back(staff);
-                  printf("measurelength part %s\n", qPrintable(id));
-                  determineMeasureLength(e, measureLength);
                   }
             }
       determineMeasureStart(measureLength, measureStart);
@@ -768,8 +888,12 @@ void MusicXml::scorePartwise(QDomElement ee)
             QString tag(e.tagName());
             if (tag == "part-list")
                   xmlPartList(e.firstChildElement());
-            else if (tag == "part")
+            else if (tag == "part") {
                   xmlPart(e.firstChildElement(), e.attribute(QString("id")));
+                  // free the dom tree of the part as soon as it is imported
+                  while (!e.firstChild().isNull())
+                        e.removeChild(e.firstChild());
+                  }
             else if (tag == "work") {
                   for (QDomElement ee = e.firstChildElement(); !ee.isNull(); ee = ee.nextSiblingElement()) {
                         if (ee.tagName() == "work-number")
@@ -1234,50 +1358,21 @@ static void allocateVoices(QMap<int, VoiceDesc>& voicelist)
 
 //---------------------------------------------------------
 //   initVoiceMapperAndMapVoices
-//   in: e is the parts first child node
+//   in: id of the part
 //---------------------------------------------------------
 
 /**
  Setup the voice mapper for a MusicXML part.
  */
 
-void MusicXml::initVoiceMapperAndMapVoices(QDomElement e)
+void MusicXml::initVoiceMapperAndMapVoices(const QString& id)
       {
-      // init
+      // the number of chordrests on each MusicXML staff was counted by prescan()
       voicelist.clear();
-      // count number of chordrests on each MusicXML staff
-      for (; !e.isNull(); e = e.nextSiblingElement()) {
-            if (e.tagName() == "measure") {
-                  for (QDomElement ee = e.firstChildElement(); !ee.isNull(); ee = ee.nextSiblingElement()) {
-                        if (ee.tagName() == "note") {
-                              bool chord = false;
-                              int voice = -1;
-                              int staff = -1;
-                              for (QDomElement eee = ee.firstChildElement(); !eee.isNull(); eee = eee.nextSiblingElement()) {
-                                    QString tag(eee.tagName());
-                                    QString s(eee.text());
-                                    if (tag == "chord")
-                                          chord = true;
-                                    else if (tag == "voice")
-                                          voice = s.toInt() - 1;
-                                    else if (tag == "staff")
-                                          staff = s.toInt() - 1;
-                                    }
-                              // set correct defaults for missing elements
-                              if (voice == -1) voice = 0;
-                              if (staff == -1) staff = 0;
-                              // count the chords (only the first note in a chord is counted)
-                              if (!chord) {
-                                    if (0 <= staff && staff < MAX_STAVES) {
-                                          if (!voicelist.contains(voice)) {
-                                                VoiceDesc vs;
-                                                voicelist.insert(voice, vs);
-                                                }
-                                          voicelist[voice].incrChordRests(staff);
-                                          }
-                                    }
-                              }
-                        }
+      foreach(const MusicXmlPartDesc& pd, partDescs) {
+            if (pd.id == id) {
+                  voicelist = pd.voicelist;
+                  break;
                   }
             }
 
@@ -1322,7 +1417,7 @@ void MusicXml::xmlPart(QDomElement e, QString id)
       multiMeasureRestCount = 0;
       startMultiMeasureRest = false;
 
-      initVoiceMapperAndMapVoices(e);
+      initVoiceMapperAndMapVoices(id);
 
       if (!score->measures()->first()) {
             doCredits();
@@ -1330,6 +1425,11 @@ void MusicXml::xmlPart(QDomElement e, QString id)
 
       for (int measureNr = 0; !e.isNull(); e = e.nextSiblingElement(), measureNr++) {
             if (e.tagName() == "measure") {
+                  if (measureNr >= measureLength.size()) {
+                        printf("Import MusicXml:xmlPart: part %s has more measures than found by the prescan\n",
+                           qPrintable(id));
+                        break;
+                        }
                   // set the correct start tick for the measure
                   tick = measureStart.at(measureNr);
                   xmlMeasure(part, e, e.attribute(QString("number")).toInt()-1, measureLength.at(measureNr));
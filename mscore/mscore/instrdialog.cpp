@@ -142,25 +142,49 @@ PartListItem::PartListItem(const InstrumentTemplate* i, QTreeWidget* lv)
 //   InstrumentTemplateListItem
 //---------------------------------------------------------
 
-InstrumentTemplateListItem::InstrumentTemplateListItem(QString group, QTreeWidget* parent)
+InstrumentTemplateListItem::InstrumentTemplateListItem(InstrumentGroup* g, bool extended, QTreeWidget* parent)
    : QTreeWidgetItem(parent) {
       _instrumentTemplate = 0;
-      _group = group;
-      setText(0, group);
+      _instrumentGroup    = g;
+      _extended           = extended;
+      _group              = g->name;
+      setText(0, _group);
+      setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
       }
 
 InstrumentTemplateListItem::InstrumentTemplateListItem(InstrumentTemplate* i, InstrumentTemplateListItem* item)
    : QTreeWidgetItem(item) {
       _instrumentTemplate = i;
+      _instrumentGroup    = 0;
       setText(0, i->trackName);
       }
 
 InstrumentTemplateListItem::InstrumentTemplateListItem(InstrumentTemplate* i, QTreeWidget* parent)
    : QTreeWidgetItem(parent) {
       _instrumentTemplate = i;
+      _instrumentGroup    = 0;
       setText(0, i->trackName);
       }
 
+//---------------------------------------------------------
+//   populate
+//    create the instrument items of a group item on
+//    first expansion
+//---------------------------------------------------------
+
+void InstrumentTemplateListItem::populate()
+      {
+      if (_instrumentGroup == 0)
+            return;
+      foreach(InstrumentTemplate* t, _instrumentGroup->instrumentTemplates) {
+            if (!_extended && t->extended)
+                  continue;
+            new InstrumentTemplateListItem(t, this);
+            }
+      _instrumentGroup = 0;
+      setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+      }
+
 //---------------------------------------------------------
 //   text
 //---------------------------------------------------------
@@ -271,6 +295,15 @@ void InstrumentsDialog::on_partiturList_itemSelectionChanged()
       linkedButton->setEnabled(item && item->type() == STAFF_LIST_ITEM);
       }
 
+//---------------------------------------------------------
+//   on_instrumentList_itemExpanded
+//---------------------------------------------------------
+
+void InstrumentsDialog::on_instrumentList_itemExpanded(QTreeWidgetItem* item)
+      {
+      populateInstrumentGroup(item);
+      }
+
 //---------------------------------------------------------
 //   on_instrumentList
 //---------------------------------------------------------
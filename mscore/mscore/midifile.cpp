@@ -18,19 +18,6 @@
 #include "libmscore/drumset.h"
 #include "libmscore/utils.h"
 
-#define BE_SHORT(x) ((((x)&0xFF)<<8) | (((x)>>8)&0xFF))
-#ifdef __i486__
-#define BE_LONG(x) \
-     ({ int __value; \
-        asm ("bswap %1; movl %1,%0" : "=g" (__value) : "r" (x)); \
-       __value; })
-#else
-#define BE_LONG(x) ((((x)&0xFF)<<24) | \
-		      (((x)&0xFF00)<<8) | \
-		      (((x)&0xFF0000)>>8) | \
-		      (((x)>>24)&0xFF))
-#endif
-
 static unsigned const char gmOnMsg[] = {
       0x7e,       // Non-Real Time header
       0x7f,       // ID of target device (7f = all devices)
@@ -82,16 +69,33 @@ MidiFile::MidiFile()
 bool MidiFile::write(QIODevice* out)
       {
       fp = out;
+
+      // the whole file is build in memory and written
+      // to the device in one go
+      int events = 0;
+      foreach (const MidiTrack* t, _tracks)
+            events += t->events().size();
+      _out.clear();
+      _out.reserve(14 + _tracks.size() * 12 + events * 4);
+
       write("MThd", 4);
       writeLong(6);                 // header len
       writeShort(_format);          // format
       writeShort(_tracks.size());
       writeShort(_division);
+      bool rv = false;
       foreach (const MidiTrack* t, _tracks) {
-            if (writeTrack(t))
-                  return true;
+            if (writeTrack(t)) {
+                  rv = true;
+                  break;
+                  }
             }
-      return false;
+      if (!rv && fp->write(_out) != _out.size()) {
+            printf("write midifile failed: %s\n", fp->errorString().toLatin1().data());
+            rv = true;
+            }
+      _out.clear();
+      return rv;
       }
 
 //---------------------------------------------------------
@@ -164,7 +168,7 @@ void MidiFile::writeEvent(const Event& event)
 bool MidiFile::writeTrack(const MidiTrack* t)
       {
       write("MTrk", 4);
-      qint64 lenpos = fp->pos();
+      int lenpos = _out.size();
       writeLong(0);                 // dummy len
 
       status   = -1;
@@ -190,10 +194,14 @@ bool MidiFile::writeTrack(const MidiTrack* t)
       put(0xff);        // Meta
       put(0x2f);        // EOT
       putvl(0);         // len 0
-      qint64 endpos = fp->pos();
-      fp->seek(lenpos);
-      writeLong(endpos-lenpos-4);   // tracklen
-      fp->seek(endpos);
+
+      // patch track len
+      int len = _out.size() - lenpos - 4;
+      uchar* p = (uchar*)_out.data() + lenpos;
+      p[0] = len >> 24;
+      p[1] = len >> 16;
+      p[2] = len >> 8;
+      p[3] = len;
       return false;
       }
 
@@ -214,226 +222,304 @@ void MidiFile::writeStatus(int nstat, int c)
       }
 
 //---------------------------------------------------------
-//   readMidi
-//    return false on error
+//   MidiParser
+//    parser state for one chunk of a midi file held
+//    in memory; reads in place
+//---------------------------------------------------------
+
+class MidiParser {
+      const uchar* _p;
+      const uchar* _end;
+      int status;                ///< running status
+      int sstatus;               ///< running status (not reset after meta or sysex events)
+      int click;                 ///< current tick position in track
+
+   public:
+      MidiParser(const uchar* p, qint64 len);
+      const uchar* pos() const   { return _p;        }
+      qint64 remaining() const   { return _end - _p; }
+      bool atEnd() const         { return _p >= _end; }
+
+      uchar get();
+      void read(void*, qint64);
+      void skip(qint64);
+      int getvl();
+      int readShort();
+      int readLong();
+      bool readEvent(Event*);
+      bool readTrack(MidiTrack*);
+      };
+
+MidiParser::MidiParser(const uchar* p, qint64 len)
+      {
+      _p      = p;
+      _end    = p + len;
+      status  = -1;
+      sstatus = -1;
+      click   = 0;
+      }
+
+//---------------------------------------------------------
+//   get
 //---------------------------------------------------------
 
-bool MidiFile::read(QIODevice* in)
-     {
-      fp = in;
-      _tracks.clear();
-      _siglist.clear();
-      _siglist.add(0, Fraction(4, 4));   // default time signature
+uchar MidiParser::get()
+      {
+      if (_p >= _end)
+            throw(QString("bad midifile: unexpected EOF"));
+      return *_p++;
+      }
 
-      curPos    = 0;
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
 
-      char tmp[4];
+void MidiParser::read(void* p, qint64 len)
+      {
+      if (len > remaining())
+            throw(QString("bad midifile: unexpected EOF"));
+      memcpy(p, _p, len);
+      _p += len;
+      }
 
-      read(tmp, 4);
-      int len = readLong();
-      if (memcmp(tmp, "MThd", 4) || len < 6)
-            throw(QString("bad midifile: MThd expected"));
+//---------------------------------------------------------
+//   skip
+//---------------------------------------------------------
 
-      _format     = readShort();
-      int ntracks = readShort();
-      _division   = readShort();
+void MidiParser::skip(qint64 len)
+      {
+      if (len <= 0)
+            return;
+      if (len > remaining())
+            throw(QString("bad midifile: unexpected EOF"));
+      _p += len;
+      }
 
-      if (_division < 0)
-            _division = (-(_division/256)) * (_division & 0xff);
-      if (len > 6)
-            skip(len-6); // skip the excess
+//---------------------------------------------------------
+//   readShort
+//   readLong
+//    big endian
+//---------------------------------------------------------
 
-      switch (_format) {
-            case 0:
-                  if (readTrack())
-                        return false;
-                  break;
-            case 1:
-                  for (int i = 0; i < ntracks; i++) {
-                        if (readTrack())
-                              return false;
-                        }
-                  break;
-            default:
-                  throw(QString("midi file format %1 not implemented").arg(_format));
-                  return false;
+int MidiParser::readShort()
+      {
+      int hi = get();
+      int lo = get();
+      return short((hi << 8) | lo);
+      }
+
+int MidiParser::readLong()
+      {
+      int val = 0;
+      for (int i = 0; i < 4; ++i)
+            val = (val << 8) | get();
+      return val;
+      }
+
+/*---------------------------------------------------------
+ *    getvl
+ *    Read variable-length number (7 bits per byte, MSB first)
+ *---------------------------------------------------------*/
+
+int MidiParser::getvl()
+      {
+      int l = 0;
+      for (int i = 0; i < 16; i++) {
+            uchar c = get();
+            l += (c & 0x7f);
+            if (!(c & 0x80)) {
+                  return l;
+                  }
+            l <<= 7;
             }
-      return true;
+      return -1;
       }
 
 //---------------------------------------------------------
 //   readTrack
-//    return true on error
+//    return false on error
 //---------------------------------------------------------
 
-bool MidiFile::readTrack()
+bool MidiParser::readTrack(MidiTrack* track)
       {
-      char tmp[4];
-      read(tmp, 4);
-      if (memcmp(tmp, "MTrk", 4))
-            throw(QString("bad midifile: MTrk expected"));
-      int len       = readLong();       // len
-      qint64 endPos = curPos + len;
-      status        = -1;
-      sstatus       = -1;  // running status, will not be reset on meta or sysex
-      click         =  0;
-      MidiTrack* track  = new MidiTrack(this);
-      _tracks.push_back(track);
-
-      int port = 0;
-      track->setOutPort(port);
-      track->setOutChannel(-1);
-
-      for (;;) {
+      while (!atEnd()) {
             Event event;
             if (!readEvent(&event))
-                  return true;
+                  return false;
 
             // check for end of track:
-            if ((event.type() == ME_META) && (event.metaType() == META_EOT))
+            if ((event.type() == ME_META) && (event.metaType() == META_EOT)) {
+                  if (!atEnd())
+                        qWarning("bad track len: %lld bytes too much\n", remaining());
                   break;
-            track->append(event);
-            }
-      if (curPos != endPos) {
-            qWarning("bad track len: %lld != %lld, %lld bytes too much\n", endPos, curPos, endPos - curPos);
-            if (curPos < endPos) {
-                  qWarning("  skip %lld\n", endPos-curPos);
-                  skip(endPos - curPos);
                   }
+            track->append(event);
             }
-      return false;
+      return true;
       }
 
-/*---------------------------------------------------------
- *    read
- *    return false on error
- *---------------------------------------------------------*/
+//---------------------------------------------------------
+//   MidiChunk
+//    a MTrk chunk located in the file data
+//---------------------------------------------------------
 
-void MidiFile::read(void* p, qint64 len)
-      {
-      curPos += len;
-      qint64 rv = fp->read((char*)p, len);
-      if (rv != len)
-            throw(QString("bad midifile: unexpected EOF"));
-      }
+struct MidiChunk {
+      MidiTrack* track;
+      const uchar* data;
+      int len;
+      bool ok;
+      QString error;
+      };
 
 //---------------------------------------------------------
-//   write
+//   readChunk
+//    called concurrently for all chunks
 //---------------------------------------------------------
 
-bool MidiFile::write(const void* p, qint64 len)
+static void readChunk(MidiChunk& chunk)
       {
-      qint64 rv = fp->write((char*)p, len);
-      if (rv == len)
-            return false;
-      printf("write midifile failed: %s\n", fp->errorString().toLatin1().data());
-      return true;
+      MidiParser parser(chunk.data, chunk.len);
+      try {
+            chunk.ok = parser.readTrack(chunk.track);
+            }
+      catch(QString s) {
+            chunk.ok    = false;
+            chunk.error = s;
+            }
       }
 
 //---------------------------------------------------------
-//   readShort
+//   readMidi
+//    return false on error
 //---------------------------------------------------------
 
-int MidiFile::readShort()
+bool MidiFile::read(QIODevice* in)
       {
-      short format;
-      read(&format, 2);
-#ifdef Q_WS_MAC
-      return QSysInfo::ByteOrder == QSysInfo::BigEndian ? format : BE_SHORT(format);
-#else
-      return BE_SHORT(format);
-#endif
+      // parse files in place from a memory mapping if possible
+      QFile* f = qobject_cast<QFile*>(in);
+      uchar* p = 0;
+      if (f && f->pos() == 0 && f->size() > 0)
+            p = f->map(0, f->size());
+      if (p) {
+            bool rv;
+            try {
+                  rv = read(p, f->size());
+                  }
+            catch(QString) {
+                  f->unmap(p);
+                  throw;
+                  }
+            f->unmap(p);
+            return rv;
+            }
+      QByteArray ba(in->readAll());
+      return read((const uchar*)ba.constData(), ba.size());
       }
 
 //---------------------------------------------------------
-//   writeShort
+//   read
+//    locate all track chunks and parse them concurrently
+//    return false on error
 //---------------------------------------------------------
 
-void MidiFile::writeShort(int i)
+bool MidiFile::read(const uchar* data, qint64 size)
       {
-#ifdef Q_WS_MAC
-	  short format;
-      if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
-		format = (short)i;
-      }else{
-        format = BE_SHORT(i);
-      }
-	  write(&format, 2);
-#else
-      int format = BE_SHORT(i);
-	  write(&format, 2);
-#endif
+      _tracks.clear();
+      _siglist.clear();
+      _siglist.add(0, Fraction(4, 4));   // default time signature
+
+      MidiParser parser(data, size);
+      char tmp[4];
+
+      parser.read(tmp, 4);
+      int len = parser.readLong();
+      if (memcmp(tmp, "MThd", 4) || len < 6)
+            throw(QString("bad midifile: MThd expected"));
+
+      _format     = parser.readShort();
+      int ntracks = parser.readShort();
+      _division   = parser.readShort();
+
+      if (_division < 0)
+            _division = (-(_division/256)) * (_division & 0xff);
+      if (len > 6)
+            parser.skip(len-6); // skip the excess
+
+      switch (_format) {
+            case 0:
+                  ntracks = 1;
+                  break;
+            case 1:
+                  break;
+            default:
+                  throw(QString("midi file format %1 not implemented").arg(_format));
+                  return false;
+            }
+
+      QList<MidiChunk> chunks;
+      for (int i = 0; i < ntracks; i++) {
+            parser.read(tmp, 4);
+            if (memcmp(tmp, "MTrk", 4))
+                  throw(QString("bad midifile: MTrk expected"));
+            int len = parser.readLong();
+            if (len < 0 || len > parser.remaining()) {
+                  qWarning("bad track len: %d, %lld bytes left\n", len, parser.remaining());
+                  len = parser.remaining();
+                  }
+            MidiTrack* track  = new MidiTrack(this);
+            track->setOutPort(0);
+            track->setOutChannel(-1);
+            _tracks.push_back(track);
+
+            MidiChunk chunk;
+            chunk.track = track;
+            chunk.data  = parser.pos();
+            chunk.len   = len;
+            chunk.ok    = false;
+            chunks.append(chunk);
+            parser.skip(len);
+            }
+
+      QtConcurrent::blockingMap(chunks, readChunk);
+
+      foreach(const MidiChunk& chunk, chunks) {
+            if (!chunk.error.isEmpty())
+                  throw(chunk.error);
+            if (!chunk.ok)
+                  return false;
+            }
+      return true;
       }
 
 //---------------------------------------------------------
-//   readLong
-//   writeLong
+//   write
+//    append to output buffer
 //---------------------------------------------------------
 
-int MidiFile::readLong()
+bool MidiFile::write(const void* p, qint64 len)
       {
-      int format;
-      read(&format, 4);
-#ifdef Q_WS_MAC
-      if (QSysInfo::ByteOrder == QSysInfo::BigEndian)
-		return format;
-      else
-            return BE_LONG(format);
-#else
-      return BE_LONG(format);
-#endif
+      _out.append((const char*)p, len);
+      return false;
       }
 
 //---------------------------------------------------------
+//   writeShort
 //   writeLong
+//    big endian
 //---------------------------------------------------------
 
-void MidiFile::writeLong(int i)
-      {
-#ifdef Q_WS_MAC
-	  int format;
-      if (QSysInfo::ByteOrder == QSysInfo::BigEndian)
-		format = i;
-      else
-            format = BE_LONG(i);
-#else
-      int format = BE_LONG(i);
-#endif
-      write(&format, 4);
-      }
-
-/*---------------------------------------------------------
- *    skip
- *    This is meant for skipping a few bytes in a
- *    file or fifo.
- *---------------------------------------------------------*/
-
-void MidiFile::skip(qint64 len)
+void MidiFile::writeShort(int i)
       {
-      if (len <= 0)
-            return;
-      char tmp[len];
-      read(tmp, len);
+      put(i >> 8);
+      put(i);
       }
 
-/*---------------------------------------------------------
- *    getvl
- *    Read variable-length number (7 bits per byte, MSB first)
- *---------------------------------------------------------*/
-
-int MidiFile::getvl()
+void MidiFile::writeLong(int i)
       {
-      int l = 0;
-      for (int i = 0; i < 16; i++) {
-            uchar c;
-            read(&c, 1);
-            l += (c & 0x7f);
-            if (!(c & 0x80)) {
-                  return l;
-                  }
-            l <<= 7;
-            }
-      return -1;
+      put(i >> 24);
+      put(i >> 16);
+      put(i >> 8);
+      put(i);
       }
 
 /*---------------------------------------------------------
@@ -482,7 +568,7 @@ MidiTrack::~MidiTrack()
 //    return true on success
 //---------------------------------------------------------
 
-bool MidiFile::readEvent(Event* event)
+bool MidiParser::readEvent(Event* event)
       {
       uchar me, a, b;
 
@@ -493,7 +579,7 @@ bool MidiFile::readEvent(Event* event)
             }
       click += nclick;
       for (;;) {
-            read(&me, 1);
+            me = get();
             if (me >= 0xf1 && me <= 0xfe && me != 0xf7) {
                   printf("Midi: Unknown Message 0x%02x\n", me & 0xff);
                   }
@@ -531,8 +617,7 @@ bool MidiFile::readEvent(Event* event)
 
       if (me == ME_META) {
             status = -1;                  // no running status
-            uchar type;
-            read(&type, 1);
+            uchar type = get();
             dataLen = getvl();                // read len
             if (dataLen == -1) {
                   printf("readEvent: error 6\n");
@@ -553,7 +638,7 @@ bool MidiFile::readEvent(Event* event)
       if (me & 0x80) {                     // status byte
             status   = me;
             sstatus  = status;
-            read(&a, 1);
+            a = get();
             }
       else {
             if (status == -1) {
@@ -574,7 +659,7 @@ bool MidiFile::readEvent(Event* event)
             case ME_POLYAFTER:
             case ME_CONTROLLER:        // controller
             case ME_PITCHBEND:        // pitch bend
-                  read(&b, 1);
+                  b = get();
                   break;
             }
       switch (status & 0xf0) {
@@ -922,30 +1007,32 @@ void MidiFile::process1()
 
 //---------------------------------------------------------
 //   quantize
-//    process one segment (measure)
+//    process one segment (measure) starting at event index
+//    *cursor; on return *cursor is the index of the first
+//    event at or after endTick
 //---------------------------------------------------------
 
-void MidiTrack::quantize(int startTick, int endTick, EventList* dst)
+void MidiTrack::quantize(int startTick, int endTick, EventList* dst, int* cursor)
       {
       int division = mf->division();
+      int n = _events.size();
 
-      iEvent i = _events.begin();
-      for (; i != _events.end(); ++i) {
-            if (i->ontime() >= startTick)
-                  break;
-            }
+      int si = *cursor;
+      while (si < n && _events.at(si).ontime() < startTick)
+            ++si;
       //
       // find shortest note in measure
       //
-      iEvent si = i;
+      int ei = si;
       int mintick = division;
-      for (; i != _events.end(); ++i) {
-            Event e = *i;
+      for (; ei < n; ++ei) {
+            const Event& e = _events.at(ei);
             if (e.ontime() >= endTick)
                   break;
             if (e.type() == ME_NOTE && (e.duration() < mintick))
                   mintick = e.duration();
             }
+      *cursor = ei;
       //
       // determine suitable quantization value based
       // on shortest note in measure
@@ -972,20 +1059,20 @@ void MidiTrack::quantize(int startTick, int endTick, EventList* dst)
 
       int raster  = mintick;
       int raster2 = raster >> 1;
-      for (iEvent i = si; i != _events.end(); ++i) {
-            Event e = *i;
-            if (e.ontime() >= endTick)
-                  break;
+      for (int i = si; i < ei; ++i) {
+            const Event& e = _events.at(i);
+            if (e.type() != ME_NOTE) {
+                  dst->insert(e);
+                  continue;
+                  }
             Event ee(e);
-            if (e.type() == ME_NOTE) {
-	            int len  = quantizeLen(e.duration(), raster);
-      	      int tick = ((e.ontime() + raster2) / raster) * raster;
+            int len  = quantizeLen(e.duration(), raster);
+            int tick = ((e.ontime() + raster2) / raster) * raster;
 
-                  ee.setNoquantOntime(e.ontime());
-                  ee.setNoquantDuration(e.duration());
-	            ee.setOntime(tick);
-      	      ee.setDuration(len);
-                  }
+            ee.setNoquantOntime(e.ontime());
+            ee.setNoquantDuration(e.duration());
+            ee.setOntime(tick);
+            ee.setDuration(len);
             dst->insert(ee);
             }
       }
@@ -1004,17 +1091,19 @@ void MidiTrack::cleanup()
       //	quantize
       //
       int lastTick = 0;
-      foreach (Event e, _events) {
+      foreach (const Event& e, _events) {
             if (e.type() != ME_NOTE)
                   continue;
             int offtime  = e.offtime();
             if (offtime > lastTick)
                   lastTick = offtime;
             }
+      const TimeSigMap& sigmap = mf->_siglist;
       int startTick = 0;
+      int cursor    = 0;
       for (int i = 1;; ++i) {
-            int endTick = mf->siglist().bar2tick(i, 0, 0);
-            quantize(startTick, endTick, &dl);
+            int endTick = sigmap.bar2tick(i, 0, 0);
+            quantize(startTick, endTick, &dl, &cursor);
             if (endTick > lastTick)
                   break;
             startTick = endTick;
@@ -1029,13 +1118,14 @@ void MidiTrack::cleanup()
       for (int i = 0; i < n; ++i) {
             Event e = dl[i];
             if (e.type() == ME_NOTE) {
-                  int ii = i + 1;
-                  for (; ii < n; ++ii) {
-                        Event ee = dl[ii];
+                  int offtime = e.ontime() + e.duration();
+                  for (int ii = i + 1; ii < n; ++ii) {
+                        const Event& ee = dl.at(ii);
+                        // dl is sorted by ontime
+                        if (ee.ontime() >= offtime)
+                              break;
                         if ((ee.type() != ME_NOTE) || (ee.pitch() != e.pitch()))
                               continue;
-                        if (ee.ontime() >= (e.ontime() + e.duration()))
-                              break;
                         printf("MidiTrack::cleanup: overlapping events: %d:%d+%d %d:%d+%d\n",
                            e.pitch(), e.ontime(), e.duration(),
                            ee.pitch(), ee.ontime(), ee.duration());
@@ -1047,7 +1137,7 @@ void MidiTrack::cleanup()
                         continue;
                         }
                   }
-		_events.insert(e);
+		_events.append(e);
             }
       }
 
@@ -1135,21 +1225,19 @@ void MidiFile::separateChannel()
                   _tracks.insert(i + 1, t);
                   t->setOutChannel(channel[ii]);
                   }
-            EventList& el = mt->events();
-            for (iEvent ie = el.begin(); ie != el.end();) {
-                  Event e = *ie;
+            EventList el;
+            foreach(const Event& e, mt->events()) {
                   if (e.isChannelEvent()) {
-                        int ch  = e.channel();
-                        int idx = channel.indexOf(ch);
+                        int idx = channel.indexOf(e.channel());
                         MidiTrack* t = _tracks.at(i + idx);
                         if (t != mt) {
-                              t->insert(e);
-                              ie = el.erase(ie);
+                              t->append(e);     // events are sorted
                               continue;
                               }
                         }
-                  ++ie;
+                  el.append(e);
                   }
+            mt->events() = el;
             i += nn - 1;
             }
       }
@@ -1194,20 +1282,23 @@ bool MidiTrack::isDrumTrack() const
 
 //---------------------------------------------------------
 //   insert
+//    keep list sorted by ontime; events with equal ontime
+//    stay in insertion order
 //---------------------------------------------------------
 
+static bool ontimeLessThan(const Event& e1, const Event& e2)
+      {
+      return e1.ontime() < e2.ontime();
+      }
+
 void EventList::insert(const Event& e)
       {
-      int ontime = e.ontime();
-      if (!isEmpty() && last().ontime() > ontime) {
-            for (iEvent i = begin(); i != end(); ++i) {
-                  if (i->ontime() > ontime) {
-                        QList<Event>::insert(i, e);
-                        return;
-                        }
-                  }
+      if (!isEmpty() && last().ontime() > e.ontime()) {
+            iEvent i = qUpperBound(begin(), end(), e, ontimeLessThan);
+            QList<Event>::insert(i, e);
             }
-      append(e);
+      else
+            append(e);
       }
 
 //---------------------------------------------------------
@@ -1396,12 +1487,15 @@ void MidiFile::readXml(QDomElement e)
 
 //---------------------------------------------------------
 //   findChords
+//    events are sorted by ontime, so only the events
+//    inside the jitter window have to be checked
 //---------------------------------------------------------
 
 void MidiTrack::findChords()
       {
       EventList dl;
       int n = _events.size();
+      QVector<bool> used(n, false);
 
       Drumset* drumset;
       if (_drumTrack)
@@ -1411,7 +1505,9 @@ void MidiTrack::findChords()
       int jitter = 3;   // tick tolerance for note on/off
 
       for (int i = 0; i < n; ++i) {
-            Event e = _events[i];
+            if (used[i])
+                  continue;
+            const Event& e = _events.at(i);
             if (e.type() == ME_INVALID)
                   continue;
             if (e.type() != ME_NOTE) {
@@ -1427,8 +1523,6 @@ void MidiTrack::findChords()
             chord.notes().append(e);
             int voice = 0;
             chord.setVoice(voice);
-            dl.append(chord);
-            _events[i].setType(ME_INVALID);
 
             bool useDrumset = false;
             if (drumset) {
@@ -1440,25 +1534,28 @@ void MidiTrack::findChords()
                         }
                   }
             for (int k = i + 1; k < n; ++k) {
-                  if (_events[k].type() != ME_NOTE)
-                        continue;
-                  Event nn = _events[k];
+                  const Event& nn = _events.at(k);
                   if (nn.ontime() - jitter > ontime)
                         break;
+                  if (used[k] || nn.type() != ME_NOTE)
+                        continue;
                   if (qAbs(nn.ontime() - ontime) > jitter || qAbs(nn.offtime() - offtime) > jitter)
                         continue;
                   int pitch = nn.pitch();
                   if (useDrumset) {
                         if (drumset->isValid(pitch) && drumset->voice(pitch) == voice) {
                               chord.notes().append(nn);
-                              _events[k].setType(ME_INVALID);
+                              used[k] = true;
                               }
                         }
                   else {
                         chord.notes().append(nn);
-                        _events[k].setType(ME_INVALID);
+                        used[k] = true;
                         }
                   }
+            // append after all notes are collected: Event is
+            // implicitly shared and would detach on modification
+            dl.append(chord);
             }
       _events = dl;
       }
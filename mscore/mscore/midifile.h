@@ -83,7 +83,7 @@ class MidiTrack {
       void move(int ticks);
       bool isDrumTrack() const;
       void extractTimeSig(TimeSigMap* sig);
-      void quantize(int startTick, int endTick, EventList* dst);
+      void quantize(int startTick, int endTick, EventList* dst, int* cursor);
       int getInitProgram();
       void findChords();
       int separateVoices(int);
@@ -106,17 +106,14 @@ class MidiTrack {
 class MidiFile {
       TimeSigMap _siglist;
       QIODevice* fp;
+      QByteArray _out;           ///< output buffer used by write()
       QList<MidiTrack*> _tracks;
       int _division;
       int _format;               ///< midi file format (0-2)
       bool _noRunningStatus;     ///< do not use running status on output
       MidiType _midiType;
 
-      // values used during read()
-      int status;                ///< running status
-      int sstatus;               ///< running status (not reset after meta or sysex events)
-      int click;                 ///< current tick position in file
-      qint64 curPos;             ///< current file byte position
+      int status;                ///< running status used by write()
       int _shortestNote;
 
       void writeEvent(const Event& event);
@@ -128,17 +125,11 @@ class MidiFile {
       void writeLong(int);
       bool writeTrack(const MidiTrack*);
       void putvl(unsigned);
-      void put(unsigned char c) { write(&c, 1); }
+      void put(unsigned char c) { _out.append(char(c)); }
       void writeStatus(int type, int channel);
 
       // read
-      void read(void*, qint64);
-      int getvl();
-      int readShort();
-      int readLong();
-      bool readEvent(Event*);
-      bool readTrack();
-      void skip(qint64);
+      bool read(const uchar*, qint64);
 
       void resetRunningStatus() { status = -1; }
 
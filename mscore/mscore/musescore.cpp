@@ -79,9 +79,14 @@
 #include "libmscore/measurebase.h"
 #include "libmscore/chordlist.h"
 #include "libmscore/volta.h"
+#include "libmscore/snapshot.h"
+#include "starttrace.h"
 
 #ifdef OSC
 #include "ofqf/qoscserver.h"
+#include "ofqf/qoscclient.h"
+#include "libmscore/measure.h"
+#include "libmscore/repeatlist.h"
 static int oscPort = 5282;
 #endif
 
@@ -108,6 +113,7 @@ bool noGui = false;
 bool externalIcons = false;
 static bool pluginMode = false;
 static bool startWithNewScore = false;
+static bool seqRender = false;
 double converterDpi = 0;
 
 QString mscoreGlobalShare;
@@ -224,6 +230,8 @@ void MuseScore::closeEvent(QCloseEvent* ev)
                   }
             }
       writeSessionFile(true);
+      autoSaveWatcher.waitForFinished();
+      removeAutoSaveNewFiles();
       foreach(Score* score, scoreList) {
             if (!score->tmpName().isEmpty()) {
                   QFile f(score->tmpName());
@@ -267,6 +275,13 @@ void MuseScore::closeEvent(QCloseEvent* ev)
       if (debugger)
             debugger->writeSettings();
 
+#ifdef OSC
+      if (oscThread) {
+            oscThread->quit();
+            oscThread->wait();
+            delete oscServer;
+            }
+#endif
       seq->stopWait();
       seq->exit();
       ev->accept();
@@ -965,7 +980,7 @@ MuseScore::MuseScore()
 
       setCentralWidget(mainWindow);
 
-      loadInstrumentTemplates(preferences.instrumentList);
+      // instrument templates are loaded by deferredInit()
       preferencesChanged();
       if (seq) {
             connect(seq, SIGNAL(started()), SLOT(seqStarted()));
@@ -981,6 +996,7 @@ MuseScore::MuseScore()
       autoSaveTimer = new QTimer(this);
       autoSaveTimer->setSingleShot(true);
       connect(autoSaveTimer, SIGNAL(timeout()), this, SLOT(autoSaveTimerTimeout()));
+      connect(&autoSaveWatcher, SIGNAL(finished()), SLOT(autoSaveFinished()));
       initOsc();
       startAutoSave();
       }
@@ -1218,6 +1234,7 @@ static void usage()
         "   -I        dump midi input\n"
         "   -O        dump midi output\n"
         "   -o file   export to 'file'; format depends on file extension\n"
+        "   -P        export audio (-o file.wav/.flac) through the sequencer\n"
         "   -r dpi    set output resolution for image export\n"
         "   -S style  load style file\n"
         "   -p name   execute named plugin\n"
@@ -1225,6 +1242,7 @@ static void usage()
         "   -i        load icons from INSTALLPATH/icons\n"
         "   -e        enable experimental features\n"
         "   -c dir    override config/settings directory\n"
+        "   -T file   write startup trace to 'file' (Chrome trace format)\n"
         );
       exit(-1);
       }
@@ -1723,6 +1741,7 @@ void MuseScore::removeTab(int i)
             }
       writeSessionFile(false);
       if (!score->tmpName().isEmpty()) {
+            autoSaveWatcher.waitForFinished();
             QFile f(score->tmpName());
             f.remove();
             }
@@ -1955,6 +1974,8 @@ static bool processNonGui()
             if (fn.endsWith(".ly"))
                   return mscore->saveLilypond(cs, fn);
 #ifdef HAS_AUDIOFILE
+            if (seqRender && (fn.endsWith(".wav") || fn.endsWith(".flac")))
+                  return seq->renderToFile(cs, fn);
             if (fn.endsWith(".wav"))
                   return mscore->saveAudio(cs, fn, "wav");
             if (fn.endsWith(".ogg"))
@@ -1978,6 +1999,8 @@ static bool processNonGui()
 
 int main(int argc, char* av[])
       {
+      StartTrace::begin("startup");
+      StartTrace::begin("application");
       QFile f(":/revision.h");
       f.open(QIODevice::ReadOnly);
       revision = QString(f.readAll());
@@ -2047,6 +2070,9 @@ int main(int argc, char* av[])
                               usage();
                         outFileName = argv.takeAt(i + 1);
                         break;
+                  case 'P':
+                        seqRender = true;
+                        break;
                   case 'p':
                         pluginMode = true;
                         noGui = true;
@@ -2073,6 +2099,11 @@ int main(int argc, char* av[])
                   case 'e':
                         enableExperimental = true;
                         break;
+                  case 'T':
+                        if (argv.size() - i < 2)
+                              usage();
+                        StartTrace::setPath(argv.takeAt(i + 1));
+                        break;
                   case 'c':
                         {
                         if (argv.size() - i < 2)
@@ -2091,6 +2122,7 @@ int main(int argc, char* av[])
                   }
             argv.removeAt(i);
             }
+      StartTrace::end();
       mscoreGlobalShare = getSharePath();
       iconPath = externalIcons ? mscoreGlobalShare + QString("icons/") :  QString(":/data/");
       iconGroup = "icons-dark/";
@@ -2136,19 +2168,28 @@ int main(int argc, char* av[])
             localeName = s.value("language", "system").toString();
             }
 
+      StartTrace::begin("locale");
       setMscoreLocale(localeName);
+      StartTrace::end();
 
+      StartTrace::begin("shortcuts");
       initShortcuts();
       preferences.init();
+      StartTrace::end();
 
       QWidget wi(0);
       PDPI = wi.logicalDpiX();         // physical resolution
       DPI  = PDPI;                     // logical drawing resolution
       DPMM = DPI / INCH;      // dots/mm
+      StartTrace::begin("libmscore");
       MScore::init();         // initialize libmscore
+      MScore::cacheDir = dataPath + "/cache/";
+      StartTrace::end();
 
+      StartTrace::begin("preferences");
       if (!useFactorySettings)
             preferences.read();
+      StartTrace::end();
 
       if (converterDpi == 0)
             converterDpi = preferences.pngResolution;
@@ -2200,14 +2241,16 @@ int main(int argc, char* av[])
                   }
             }
 
+      //
+      // the sequencer (audio driver, sound font, Aeolus) is
+      // started from MuseScore::deferredInit() once the main
+      // window is visible; converter and plugin runs do not
+      // need it at all
+      //
       synti = new MasterSynth();
       seq   = new Seq();
-      if (!noSeq) {
-            if (!seq->init()) {
-                  printf("sequencer init failed\n");
-                  noSeq = true;
-                  }
-            }
+      if (noGui)
+            noSeq = true;
       //
       // avoid font problems by overriding the environment
       //    fall back to "C" locale
@@ -2228,14 +2271,18 @@ int main(int argc, char* av[])
       //   staff has 5 lines = 4 * _spatium
       //   _spatium    = SPATIUM20  * DPI;     // 20.0 / 72.0 * DPI / 4.0;
 
+      StartTrace::begin("icons");
       genIcons();
 //      initShortcuts();
 
       if (!converterMode)
             qApp->setWindowIcon(*icons[window_ICON]);
+      StartTrace::end();
       initProfile();
+      StartTrace::begin("main window");
       mscore = new MuseScore();
       gscore = new Score(MScore::defaultStyle());
+      StartTrace::end();
 
       //read languages list
       mscore->readLanguages(mscoreGlobalShare + "locale/languages.xml");
@@ -2248,12 +2295,24 @@ int main(int argc, char* av[])
 #endif
       mscore->setRevision(revision);
 
-MScore::init();         // initialize libmscore
       if (noGui) {
+            if (pluginMode) {
+                  StartTrace::begin("instrument templates");
+                  loadInstrumentTemplates(preferences.instrumentList);
+                  StartTrace::end();
+                  }
+            StartTrace::begin("load scores");
             loadScores(argv);
-            exit(processNonGui() ? 0 : -1);
+            StartTrace::end();
+            StartTrace::begin("process");
+            bool rv = processNonGui();
+            StartTrace::end();
+            StartTrace::end();      // startup
+            StartTrace::write();
+            exit(rv ? 0 : -1);
             }
       else {
+            StartTrace::begin("load scores");
             mscore->readSettings();
             QObject::connect(qApp, SIGNAL(messageReceived(const QString&)),
                mscore, SLOT(handleMessage(const QString&)));
@@ -2275,8 +2334,8 @@ MScore::init();         // initialize libmscore
             if (!mscore->restoreSession((preferences.sessionStart == LAST_SESSION) && (files == 0)) || files)
                   loadScores(argv);
 #endif
+            StartTrace::end();
             }
-      mscore->loadPlugins();
       mscore->writeSessionFile(false);
       mscore->changeState(STATE_DISABLED);   // DEBUG
 
@@ -2286,9 +2345,13 @@ MScore::init();         // initialize libmscore
       mscore->setUnifiedTitleAndToolBarOnMac(false);
 #endif
 
+      StartTrace::begin("show");
       mscore->show();
       if (sc)
             sc->finish(mscore);
+      StartTrace::end();
+      StartTrace::end();      // startup
+      QTimer::singleShot(0, mscore, SLOT(deferredInit()));
       if (debugMode)
             printf("start event loop...\n");
       if (mscore->hasToCheckForUpdate())
@@ -2296,6 +2359,41 @@ MScore::init();         // initialize libmscore
       return qApp->exec();
       }
 
+//---------------------------------------------------------
+//   deferredInit
+//    initialize what is not needed to show the main
+//    window; called from the event loop right after
+//    the window came up
+//---------------------------------------------------------
+
+void MuseScore::deferredInit()
+      {
+      StartTrace::begin("deferred init");
+      if (!noSeq) {
+            StartTrace::begin("sequencer");
+            if (!seq->init()) {
+                  printf("sequencer init failed\n");
+                  noSeq = true;
+                  transportTools->setEnabled(false);
+                  playId->setEnabled(false);
+                  }
+            else if (cv)
+                  seq->setScoreView(cv);  // send instrument setup of the current score
+            StartTrace::end();
+            }
+      StartTrace::begin("instrument templates");
+      loadInstrumentTemplates(preferences.instrumentList);
+      StartTrace::end();
+
+      StartTrace::begin("plugins");
+      loadPlugins();
+      foreach(QAction* a, pluginActions)
+            a->setEnabled(_sstate != STATE_DISABLED);
+      StartTrace::end();
+      StartTrace::end();
+      StartTrace::write();
+      }
+
 //---------------------------------------------------------
 //   unstable
 //---------------------------------------------------------
@@ -3030,43 +3128,111 @@ void MuseScore::removeSessionFile()
 
 //---------------------------------------------------------
 //   autoSaveTimerTimeout
+//    serialize all changed scores into memory and let
+//    a background thread compress and write them
 //---------------------------------------------------------
 
 void MuseScore::autoSaveTimerTimeout()
       {
-      bool sessionChanged = false;
+      if (autoSaveWatcher.isRunning()) {  // last autosave is still writing
+            startAutoSave();
+            return;
+            }
+      QList<ScoreSnapshot> sl;
+      autoSaveHashes.clear();
+      autoSaveNewFiles.clear();
+      QTime t;
+      t.start();
       foreach(Score* s, scoreList) {
-            if (s->autosaveDirty()) {
-                  QString tmp = s->tmpName();
-                  if (!tmp.isEmpty()) {
-                        QFileInfo fi(tmp);
-                        // TODO: cannot catch exeption here:
-                        cs->saveCompressedFile(fi, false);
+            if (!s->autosaveDirty())
+                  continue;
+            //
+            // the temporary file of a score is recorded with
+            // setTmpName() only after its first snapshot is
+            // written, so the session never points to an
+            // empty file
+            //
+            QString path = s->tmpName();
+            if (path.isEmpty()) {
+                  QDir dir;
+                  dir.mkpath(dataPath);
+                  QTemporaryFile tf(dataPath + "/scXXXXXX.mscz");
+                  tf.setAutoRemove(false);
+                  if (!tf.open()) {
+                        printf("autoSaveTimerTimeout(): create temporary file failed\n");
+                        break;
                         }
-                  else {
-                        QDir dir;
-                        dir.mkpath(dataPath);
-                        QTemporaryFile tf(dataPath + "/scXXXXXX.mscz");
-                        tf.setAutoRemove(false);
-                        if (!tf.open()) {
-                              printf("autoSaveTimerTimeout(): create temporary file failed\n");
-                              return;
-                              }
-                        s->setTmpName(tf.fileName());
-                        QFileInfo info(tf.fileName());
-                        s->saveCompressedFile(&tf, info, false);
-                        tf.close();
+                  tf.close();
+                  path = tf.fileName();
+                  autoSaveNewFiles.insert(s, path);
+                  }
+            ScoreSnapshot ss;
+            try {
+                  s->snapshot(&ss, path);
+                  }
+            catch (QString e) {
+                  printf("autoSaveTimerTimeout(): %s\n", qPrintable(e));
+                  continue;
+                  }
+            s->setAutosaveDirty(false);
+            if (ss.hash == s->autosaveHash())   // changed back to the autosaved state
+                  continue;
+            autoSaveHashes.insert(ss.path, ss.hash);
+            sl.append(ss);
+            }
+      if (debugMode)
+            printf("autosave: %d snapshots serialized in %d ms\n", sl.size(), t.elapsed());
+      if (sl.isEmpty()) {
+            removeAutoSaveNewFiles();
+            startAutoSave();
+            return;
+            }
+      autoSaveWatcher.setFuture(QtConcurrent::run(writeSnapshots, sl));
+      }
+
+//---------------------------------------------------------
+//   removeAutoSaveNewFiles
+//    remove the temporary files created for scores whose
+//    first snapshot was not written
+//---------------------------------------------------------
+
+void MuseScore::removeAutoSaveNewFiles()
+      {
+      foreach(const QString& path, autoSaveNewFiles)
+            QFile::remove(path);
+      autoSaveNewFiles.clear();
+      }
+
+//---------------------------------------------------------
+//   autoSaveFinished
+//    the background thread has written the snapshots
+//---------------------------------------------------------
+
+void MuseScore::autoSaveFinished()
+      {
+      QStringList written = autoSaveWatcher.result();
+      bool sessionChanged = false;
+      foreach(Score* s, scoreList) {
+            bool newFile = autoSaveNewFiles.contains(s);
+            QString path = newFile ? autoSaveNewFiles[s] : s->tmpName();
+            if (!autoSaveHashes.contains(path))
+                  continue;
+            if (written.contains(path)) {
+                  if (newFile) {
+                        s->setTmpName(path);
+                        autoSaveNewFiles.remove(s);
                         sessionChanged = true;
                         }
-                  s->setAutosaveDirty(false);
+                  s->setAutosaveHash(autoSaveHashes[path]);
                   }
+            else
+                  s->setAutosaveDirty(true);    // try again next time
             }
+      autoSaveHashes.clear();
+      removeAutoSaveNewFiles();           // failed or score closed meanwhile
       if (sessionChanged)
             writeSessionFile(false);
-      if (preferences.autoSave) {
-            int t = preferences.autoSaveTime * 60 * 1000;
-            autoSaveTimer->start(t);
-            }
+      startAutoSave();
       }
 
 //---------------------------------------------------------
@@ -3320,6 +3486,12 @@ void MuseScore::initOsc()
 
 void MuseScore::initOsc()
       {
+      oscThread         = 0;
+      oscServer         = 0;
+      oscFeedback       = 0;
+      oscFeedbackTimer  = 0;
+      oscPlaying        = false;
+      oscLastTick       = -1;
       if (!preferences.useOsc)
             return;
       int port;
@@ -3327,7 +3499,14 @@ void MuseScore::initOsc()
             port = oscPort;
       else
             port = preferences.oscPort;
-      QOscServer* osc = new QOscServer(port, qApp);
+      //
+      // the server lives in its own thread, so incoming messages are
+      // received and decoded even if the gui is busy; transport
+      // messages which need no gui (tempo, volume) are directly
+      // forwarded to the sequencer, all others are queued to the
+      // gui thread
+      //
+      QOscServer* osc = new QOscServer(port, 0);
       PathObject* oo = new PathObject( "/mscore", QVariant::Int, osc);
       QObject::connect(oo, SIGNAL(data(int)), SLOT(oscIntMessage(int)));
       oo = new PathObject( "/play", QVariant::Int, osc);
@@ -3335,9 +3514,10 @@ void MuseScore::initOsc()
       oo = new PathObject( "/stop", QVariant::Int, osc);
       QObject::connect(oo, SIGNAL(data(int)), SLOT(oscStop()));
       oo = new PathObject( "/tempo", QVariant::Int, osc);
+      QObject::connect(oo, SIGNAL(data(int)), seq, SLOT(oscTempo(int)), Qt::DirectConnection);
       QObject::connect(oo, SIGNAL(data(int)), SLOT(oscTempo(int)));
       oo = new PathObject( "/volume", QVariant::Int, osc);
-      QObject::connect(oo, SIGNAL(data(int)), SLOT(oscVolume(int)));
+      QObject::connect(oo, SIGNAL(data(int)), seq, SLOT(oscVolume(int)), Qt::DirectConnection);
       oo = new PathObject( "/next", QVariant::Int, osc);
       QObject::connect(oo, SIGNAL(data(int)), SLOT(oscNext()));
       oo = new PathObject( "/next-measure", QVariant::Int, osc);
@@ -3358,6 +3538,48 @@ void MuseScore::initOsc()
             oo = new PathObject( QString("/mute%1").arg(i), QVariant::Double, osc);
             QObject::connect(oo, SIGNAL(data(double)), SLOT(oscMuteChannel(double)));
             }
+      oscServer = osc;
+      oscThread = new QThread(this);
+      oscServer->moveToThread(oscThread);
+      oscThread->start(QThread::HighPriority);
+
+      if (preferences.oscFeedbackRate > 0) {
+            oscFeedback = new QOscClient(QHostAddress(preferences.oscFeedbackHost),
+               preferences.oscFeedbackPort, this);
+            oscFeedbackTimer = new QTimer(this);
+            connect(oscFeedbackTimer, SIGNAL(timeout()), SLOT(oscSendPosition()));
+            oscFeedbackTimer->start(1000 / preferences.oscFeedbackRate);
+            }
+      }
+
+//---------------------------------------------------------
+//   oscSendPosition
+//    send the current play position as
+//    "/position measure tick" and transport changes as
+//    "/playing 0|1" to the feedback address
+//---------------------------------------------------------
+
+void MuseScore::oscSendPosition()
+      {
+      bool playing = cs && seq && seq->isPlaying();
+      if (playing != oscPlaying) {
+            oscPlaying = playing;
+            oscFeedback->sendData("/playing", QVariant(int(playing)));
+            }
+      if (!playing) {
+            oscLastTick = -1;
+            return;
+            }
+      int utick = seq->getCurTick();
+      if (utick == oscLastTick)
+            return;
+      oscLastTick = utick;
+      int tick = cs->repeatList()->utick2tick(utick);
+      Measure* m = cs->tick2measure(tick);
+      QList<QVariant> args;
+      args.append(m ? m->no() + 1 : 0);
+      args.append(tick);
+      oscFeedback->sendData("/position", args);
       }
 
 //---------------------------------------------------------
@@ -3417,6 +3639,8 @@ void MuseScore::oscSelectMeasure(int m)
 
 //---------------------------------------------------------
 //   oscTempo
+//    the sequencer got the tempo change already from
+//    the osc thread (Seq::oscTempo()), only update the gui
 //---------------------------------------------------------
 
 void MuseScore::oscTempo(int val)
@@ -3427,20 +3651,7 @@ void MuseScore::oscTempo(int val)
             val = 127;
       val = (val * 240) / 128;
       if (playPanel)
-            playPanel->setRelTempo(val);
-      if (seq)
-            seq->setRelTempo(double(val));
-      }
-
-//---------------------------------------------------------
-//   oscVolume
-//---------------------------------------------------------
-
-void MuseScore::oscVolume(int val)
-      {
-      double v = val / 128.0;
-      if (seq)
-            seq->setGain(v);
+            playPanel->setRelTempo(val * .01);
       }
 
 //---------------------------------------------------------
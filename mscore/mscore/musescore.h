@@ -33,6 +33,8 @@
 
 class ScoreView;
 class Element;
+class QOscServer;
+class QOscClient;
 class ToolButton;
 class PreferenceDialog;
 class InstrumentsDialog;
@@ -247,6 +249,9 @@ class MuseScore : public QMainWindow {
       QScriptEngineDebugger* scriptDebugger;
 
       QTimer* autoSaveTimer;
+      QFutureWatcher<QStringList> autoSaveWatcher;    ///< writes the autosave snapshots
+      QMap<QString, QByteArray> autoSaveHashes;       ///< path and hash of the snapshots being written
+      QMap<Score*, QString> autoSaveNewFiles;         ///< temporary files of scores autosaved the first time
       QList<QAction*> pluginActions;
       QSignalMapper* pluginMapper;
 
@@ -295,6 +300,15 @@ class MuseScore : public QMainWindow {
       QAction* metronomeAction;
       QAction* panAction;
 
+#ifdef OSC
+      QThread* oscThread;           ///< runs the osc server
+      QOscServer* oscServer;
+      QOscClient* oscFeedback;      ///< sends play position to remote controller
+      QTimer* oscFeedbackTimer;
+      bool oscPlaying;
+      int oscLastTick;
+#endif
+
       //---------------------
 
       virtual void closeEvent(QCloseEvent*);
@@ -306,6 +320,7 @@ class MuseScore : public QMainWindow {
       void launchBrowser(const QString whereTo);
 
       void loadScoreList();
+      void removeAutoSaveNewFiles();
       void editInstrList();
       void symbolMenu();
       void clefMenu();
@@ -348,6 +363,7 @@ class MuseScore : public QMainWindow {
 
    private slots:
       void autoSaveTimerTimeout();
+      void autoSaveFinished();
       void helpBrowser1();
       void about();
       void aboutQt();
@@ -381,8 +397,8 @@ class MuseScore : public QMainWindow {
       void oscIntMessage(int);
       void oscPlay();
       void oscStop();
-      void oscVolume(int val);
       void oscTempo(int val);
+      void oscSendPosition();
       void oscNext();
       void oscNextMeasure();
       void oscGoto(int m);
@@ -398,6 +414,7 @@ class MuseScore : public QMainWindow {
       void changeProfile(Profile* p);
       void switchLayer(const QString&);
       void networkFinished(QNetworkReply*);
+      void deferredInit();
 
    public slots:
       void dirtyChanged(Score*);
@@ -167,6 +167,20 @@ class JumpMarkerDesc {
 
 typedef QList<JumpMarkerDesc> JumpMarkerDescList;
 
+//---------------------------------------------------------
+//   MusicXmlPartDesc
+//---------------------------------------------------------
+
+/**
+ The data collected for a single MusicXML part by the pre-scan.
+*/
+
+struct MusicXmlPartDesc {
+      QString id;
+      QVector<int> measureLength;       ///< Length of each measure in ticks
+      QMap<int, VoiceDesc> voicelist;   ///< Number of chordrests per voice and staff
+      };
+
 //---------------------------------------------------------
 //   MusicXml
 //---------------------------------------------------------
@@ -180,6 +194,7 @@ class MusicXml {
       QMap<int, VoiceDesc> voicelist;
       QVector<int> measureLength;               ///< Length of each measure in ticks
       QVector<int> measureStart;                ///< Start tick of each measure
+      QList<MusicXmlPartDesc> partDescs;        ///< Result of the pre-scan
 
       Slur* slur[MAX_NUMBER_LEVEL];
 
@@ -191,6 +206,7 @@ class MusicXml {
       Volta* lastVolta;
 
       QDomDocument* doc;
+      QByteArray data;  ///< Raw document, used by the pre-scan and then released
       int tick;         ///< Current position in MusicXML time
       int maxtick;      ///< Maxtick of a measure, used to calculate measure len
       int prevtick;     ///< Previous notes tick (used to insert Jumps)
@@ -238,11 +254,12 @@ class MusicXml {
       void xmlNote(Measure*, int stave, QDomElement node);
       void xmlHarmony(QDomElement node, int tick, Measure* m, int staff);
       void xmlClef(QDomElement, int staffIdx, Measure*);
-      void initVoiceMapperAndMapVoices(QDomElement e);
+      bool prescan(const QByteArray&);
+      void initVoiceMapperAndMapVoices(const QString& id);
 
    public:
-      MusicXml(QDomDocument* d);
-      void import(Score*);
+      MusicXml(QDomDocument* d, const QByteArray& data);
+      bool import(Score*);
       };
 
 //---------------------------------------------------------
@@ -111,6 +111,15 @@ void InstrumentWizard::on_partiturList_itemSelectionChanged()
       belowButton->setEnabled(item && item->type() == STAFF_LIST_ITEM);
       }
 
+//---------------------------------------------------------
+//   on_instrumentList_itemExpanded
+//---------------------------------------------------------
+
+void InstrumentWizard::on_instrumentList_itemExpanded(QTreeWidgetItem* item)
+      {
+      populateInstrumentGroup(item);
+      }
+
 //---------------------------------------------------------
 //   on_instrumentList
 //---------------------------------------------------------
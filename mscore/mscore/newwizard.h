@@ -43,6 +43,7 @@ class InstrumentWizard : public QWidget, private Ui::InstrumentWizard {
       void on_partiturList_itemSelectionChanged();
       void on_instrumentList_itemSelectionChanged();
       void on_instrumentList_itemActivated(QTreeWidgetItem* item, int);
+      void on_instrumentList_itemExpanded(QTreeWidgetItem*);
       void on_removeButton_clicked();
       void on_upButton_clicked();
       void on_downButton_clicked();
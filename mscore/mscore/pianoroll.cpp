@@ -182,17 +182,16 @@ void PianorollEditor::setStaff(Staff* st)
 
 void PianorollEditor::updateSelection()
       {
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() == 1) {
-            QGraphicsItem* item = items[0];
-            Note* note = static_cast<Note*>(item->data(0).value<void*>());
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() == 1) {
+            Note* note = notes[0];
             pitch->setEnabled(true);
             pitch->setValue(note->pitch());
             veloType->setEnabled(true);
             velocity->setEnabled(true);
             updateVelocity(note);
             }
-      else if (items.size() == 0) {
+      else if (notes.size() == 0) {
             velocity->setValue(0);
             velocity->setEnabled(false);
             pitch->setValue(0);
@@ -220,23 +219,16 @@ void PianorollEditor::selectionChanged()
       {
       updateSelection();
 //      _score->blockSignals(true);
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() == 1) {
-            QGraphicsItem* item = items[0];
-            Note* note = static_cast<Note*>(item->data(0).value<void*>());
-            if (note)
-                  _score->select(note, SELECT_SINGLE, 0);
-            }
-      else if (items.size() == 0) {
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() == 1)
+            _score->select(notes[0], SELECT_SINGLE, 0);
+      else if (notes.size() == 0) {
             _score->select(0, SELECT_SINGLE, 0);
             }
       else {
             _score->select(0, SELECT_SINGLE, 0);
-            foreach(QGraphicsItem* item, items) {
-                  Note* note = static_cast<Note*>(item->data(0).value<void*>());
-                  if (note)
-                        _score->select(note, SELECT_ADD, 0);
-                  }
+            foreach(Note* note, notes)
+                  _score->select(note, SELECT_ADD, 0);
             }
       _score->setUpdateAll();
       _score->end();
@@ -266,11 +258,10 @@ void PianorollEditor::changeSelection(int)
 
 void PianorollEditor::veloTypeChanged(int val)
       {
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() != 1)
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() != 1)
             return;
-      QGraphicsItem* item = items[0];
-      Note* note = (Note*)item->data(0).value<void*>();
+      Note* note = notes[0];
       if ((note == 0) || (ValueType(val) == note->veloType()))
             return;
 
@@ -324,11 +315,10 @@ void PianorollEditor::updateVelocity(Note* note)
 
 void PianorollEditor::velocityChanged(int val)
       {
-      QList<QGraphicsItem*> items = gv->scene()->selectedItems();
-      if (items.size() != 1)
+      QList<Note*> notes = gv->selectedNotes();
+      if (notes.size() != 1)
             return;
-      QGraphicsItem* item = items[0];
-      Note* note = (Note*)item->data(0).value<void*>();
+      Note* note = notes[0];
       if (note == 0)
             return;
       ValueType vt = note->veloType();
@@ -395,16 +385,11 @@ void PianorollEditor::cmd(QAction* a)
       {
       score()->startCmd();
       if (a->data() == "delete") {
-            QList<QGraphicsItem*> items = gv->items();
-            foreach(QGraphicsItem* item, items) {
-                  Note* note = static_cast<Note*>(item->data(0).value<void*>());
-                  if (note) {
-                        score()->deleteItem(note);
-                        }
-                  }
+            foreach(Note* note, gv->selectedNotes())
+                  score()->deleteItem(note);
             }
 
-      gv->setStaff(staff, locator);
+      gv->updateNotes();
       score()->endCmd();
       }
 
@@ -46,22 +46,122 @@ static int pitch2y(int pitch)
       return y;
       }
 
+//---------------------------------------------------------
+//   NoteIndex
+//---------------------------------------------------------
+
+void NoteIndex::clear()
+      {
+      for (int i = 0; i < 128; ++i) {
+            _notes[i].clear();
+            _maxLen[i] = 0;
+            }
+      }
+
+//---------------------------------------------------------
+//   append
+//    notes have to be appended in tick order
+//---------------------------------------------------------
+
+void NoteIndex::append(int pitch, int tick, int len, Note* note, NoteEvent* event)
+      {
+      if (pitch < 0 || pitch > 127)
+            return;
+      NoteIndexEntry e;
+      e.tick  = tick;
+      e.len   = len;
+      e.note  = note;
+      e.event = event;
+      _notes[pitch].append(e);
+      if (len > _maxLen[pitch])
+            _maxLen[pitch] = len;
+      }
+
+//---------------------------------------------------------
+//   find
+//    append all notes of pitch which overlap tick1 - tick2
+//    to list
+//---------------------------------------------------------
+
+void NoteIndex::find(int pitch, int tick1, int tick2, QList<NoteIndexEntry>* list) const
+      {
+      const QVector<NoteIndexEntry>& v = _notes[pitch];
+      //
+      // binary search for the first note which can reach
+      // into the range
+      //
+      int start = tick1 - _maxLen[pitch];
+      int lo = 0;
+      int hi = v.size();
+      while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (v[mid].tick < start)
+                  lo = mid + 1;
+            else
+                  hi = mid;
+            }
+      for (int i = lo; i < v.size(); ++i) {
+            const NoteIndexEntry& e = v[i];
+            if (e.tick > tick2)
+                  break;
+            if (e.tick + e.len >= tick1)
+                  list->append(e);
+            }
+      }
+
+//---------------------------------------------------------
+//   selectedNotes
+//---------------------------------------------------------
+
+QList<Note*> NoteIndex::selectedNotes() const
+      {
+      QList<Note*> nl;
+      for (int pitch = 0; pitch < 128; ++pitch) {
+            const Note* last = 0;
+            foreach(const NoteIndexEntry& e, _notes[pitch]) {
+                  if (e.note != last && e.note->selected())
+                        nl.append(e.note);
+                  last = e.note;
+                  }
+            }
+      return nl;
+      }
+
+//---------------------------------------------------------
+//   isEmpty
+//---------------------------------------------------------
+
+bool NoteIndex::isEmpty() const
+      {
+      for (int i = 0; i < 128; ++i) {
+            if (!_notes[i].isEmpty())
+                  return false;
+            }
+      return true;
+      }
+
 //---------------------------------------------------------
 //   PianoItem
 //---------------------------------------------------------
 
 PianoItem::PianoItem(Note* n, NoteEvent* e)
-   : QGraphicsRectItem(), note(n), event(e)
+   : QGraphicsRectItem(), _note(n), _event(e)
       {
       setFlags(flags() | QGraphicsItem::ItemIsSelectable);
-      int pitch = n->pitch();
-      int len   = n->playTicks();
-      setRect(0, 0, len, keyHeight/2);
       setBrush(QBrush());
       setSelected(n->selected());
       setData(0, QVariant::fromValue<void*>(n));
+      updateValues();
+      }
+
+//---------------------------------------------------------
+//   updateValues
+//---------------------------------------------------------
 
-      setPos(n->chord()->tick() + 480, pitch2y(pitch) + keyHeight / 4);
+void PianoItem::updateValues()
+      {
+      setRect(0, 0, _note->playTicks(), keyHeight/2);
+      setPos(_note->chord()->tick() + 480, pitch2y(_note->pitch()) + keyHeight / 4);
       }
 
 //---------------------------------------------------------
@@ -70,9 +170,9 @@ PianoItem::PianoItem(Note* n, NoteEvent* e)
 
 void PianoItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*)
       {
-      Chord* chord = note->chord();
-      int x1       = note->onTimeOffset() + note->onTimeUserOffset();
-      int x2       = note->playTicks() + note->offTimeOffset() + note->offTimeUserOffset();
+      Chord* chord = _note->chord();
+      int x1       = _note->onTimeOffset() + _note->onTimeUserOffset();
+      int x2       = _note->playTicks() + _note->offTimeOffset() + _note->offTimeUserOffset();
       painter->setPen(pen());
       painter->setBrush(isSelected() ? Qt::yellow : Qt::blue);
       painter->drawRect(x1, 0.0, x2-x1, keyHeight / 2);
@@ -281,6 +381,7 @@ void PianoView::setChord(Chord* c, Pos* l)
 
       scene()->blockSignals(true);
 
+      visibleItems.clear();
       scene()->clear();
       for (int i = 0; i < 3; ++i) {
             locatorLines[i] = new QGraphicsLineItem(QLineF(0.0, 0.0, 0.0, keyHeight * 75.0 * 5));
@@ -291,18 +392,8 @@ void PianoView::setChord(Chord* c, Pos* l)
             locatorLines[i]->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
             scene()->addItem(locatorLines[i]);
             }
-
-      foreach(Note* note, c->notes()) {
-            if (!note->playEvents().isEmpty()) {
-//                  int ticks = note->playTicks();
-                  foreach(NoteEvent* e, note->playEvents())
-                        scene()->addItem(new PianoItem(note, e));
-                  }
-            else
-                  scene()->addItem(new PianoItem(note, new NoteEvent));
-            }
-
       scene()->blockSignals(false);
+      buildIndex();
 
 //      Measure* lm = staff->score()->lastMeasure();
       ticks       = chord->tick() + chord->actualTicks();
@@ -313,14 +404,8 @@ void PianoView::setChord(Chord* c, Pos* l)
       //
       // move to something interesting
       //
-      QList<QGraphicsItem*> items = scene()->selectedItems();
-      QRectF boundingRect;
-      foreach(QGraphicsItem* item, items) {
-            Note* note = static_cast<Note*>(item->data(0).value<void*>());
-            if (note)
-                  boundingRect |= item->mapToScene(item->boundingRect()).boundingRect();
-            }
-      centerOn(boundingRect.center());
+      centerOn(QPointF(chord->tick() + MAP_OFFSET, pitch2y(chord->upNote()->pitch())));
+      updateItems();
       }
 
 //---------------------------------------------------------
@@ -332,11 +417,13 @@ void PianoView::setStaff(Staff* s, Pos* l)
       static const QColor lcColors[3] = { Qt::red, Qt::blue, Qt::blue };
 
       staff    = s;
+      chord    = 0;
       _locator = l;
       pos.setContext(s->score()->tempomap(), s->score()->sigmap());
 
       scene()->blockSignals(true);
 
+      visibleItems.clear();
       scene()->clear();
       for (int i = 0; i < 3; ++i) {
             locatorLines[i] = new QGraphicsLineItem(QLineF(0.0, 0.0, 0.0, keyHeight * 75.0 * 5));
@@ -347,7 +434,49 @@ void PianoView::setStaff(Staff* s, Pos* l)
             locatorLines[i]->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
             scene()->addItem(locatorLines[i]);
             }
+      scene()->blockSignals(false);
+      buildIndex();
+
+      Measure* lm = staff->score()->lastMeasure();
+      ticks       = lm->tick() + lm->ticks();
+      scene()->setSceneRect(0.0, 0.0, double(ticks + 960), keyHeight * 75);
+
+      for (int i = 0; i < 3; ++i)
+            moveLocator(i);
+      //
+      // move to something interesting
+      //
+      QRectF boundingRect;
+      foreach(Note* note, index.selectedNotes()) {
+            boundingRect |= QRectF(note->chord()->tick() + MAP_OFFSET, pitch2y(note->pitch()),
+               note->playTicks(), keyHeight / 2);
+            }
+      centerOn(boundingRect.center());
+      updateItems();
+      }
 
+//---------------------------------------------------------
+//   buildIndex
+//    collect the notes of the staff (or the chord) into
+//    the note index; this is cheap compared to creating
+//    graphics items for all of them
+//---------------------------------------------------------
+
+void PianoView::buildIndex()
+      {
+      index.clear();
+      if (chord) {
+            foreach(Note* note, chord->notes()) {
+                  int len = qMax(note->playTicks(), chord->actualTicks());
+                  if (!note->playEvents().isEmpty()) {
+                        foreach(NoteEvent* e, note->playEvents())
+                              index.append(note->pitch(), chord->tick(), len, note, e);
+                        }
+                  else
+                        index.append(note->pitch(), chord->tick(), len, note, 0);
+                  }
+            return;
+            }
       int staffIdx = staff->idx();
       int startTrack = staffIdx * VOICES;
       int endTrack   = startTrack + VOICES;
@@ -357,33 +486,126 @@ void PianoView::setStaff(Staff* s, Pos* l)
                   if (e == 0 || e->type() != CHORD)
                         continue;
                   Chord* chord = static_cast<Chord*>(e);
+                  int tick = chord->tick();
                   foreach(Note* n, chord->notes()) {
                         if (n->tieBack())
                               continue;
+                        int len = qMax(n->playTicks(), chord->actualTicks());
                         foreach(NoteEvent* e, n->playEvents())
-                              scene()->addItem(new PianoItem(n, e));
+                              index.append(n->pitch(), tick, len, n, e);
                         }
                   }
             }
+      }
+
+//---------------------------------------------------------
+//   updateItems
+//    create graphics items for the notes in the visible
+//    area (plus one screen to the left and right) and
+//    remove all others; items of notes which stay
+//    visible are reused
+//---------------------------------------------------------
+
+void PianoView::updateItems()
+      {
+      if (staff == 0)
+            return;
+      QRectF r = mapToScene(viewport()->rect()).boundingRect();
+      qreal w  = r.width();
+      r.adjust(-w, -keyHeight, w, keyHeight);
+      int tick1 = int(r.left()) - MAP_OFFSET;
+      int tick2 = int(r.right()) - MAP_OFFSET;
+
+      QList<NoteIndexEntry> nl;
+      for (int pitch = 0; pitch < 128; ++pitch) {
+            int y = pitch2y(pitch);
+            if (y < r.top() || y > r.bottom())
+                  continue;
+            index.find(pitch, tick1, tick2, &nl);
+            }
+
+      scene()->blockSignals(true);
+      QHash<NoteKey, PianoItem*> items;
+      foreach(const NoteIndexEntry& e, nl) {
+            NoteKey key(e.note, e.event);
+            PianoItem* item = visibleItems.take(key);
+            if (item)
+                  item->updateValues();
+            else {
+                  item = new PianoItem(e.note, e.event);
+                  scene()->addItem(item);
+                  }
+            items.insert(key, item);
+            }
+      foreach(PianoItem* item, visibleItems)
+            delete item;
+      visibleItems = items;
       scene()->blockSignals(false);
+      }
 
-      Measure* lm = staff->score()->lastMeasure();
-      ticks       = lm->tick() + lm->ticks();
-      scene()->setSceneRect(0.0, 0.0, double(ticks + 960), keyHeight * 75);
+//---------------------------------------------------------
+//   updateNotes
+//    called after the score was edited; rebuilds the
+//    note index and updates only the visible items
+//---------------------------------------------------------
 
-      for (int i = 0; i < 3; ++i)
-            moveLocator(i);
-      //
-      // move to something interesting
-      //
-      QList<QGraphicsItem*> items = scene()->selectedItems();
-      QRectF boundingRect;
-      foreach(QGraphicsItem* item, items) {
-            Note* note = static_cast<Note*>(item->data(0).value<void*>());
-            if (note)
-                  boundingRect |= item->mapToScene(item->boundingRect()).boundingRect();
+void PianoView::updateNotes()
+      {
+      if (staff == 0)
+            return;
+      buildIndex();
+      if (chord == 0) {
+            Measure* lm = staff->score()->lastMeasure();
+            ticks       = lm->tick() + lm->ticks();
+            scene()->setSceneRect(0.0, 0.0, double(ticks + 960), keyHeight * 75);
             }
-      centerOn(boundingRect.center());
+      updateItems();
+      }
+
+//---------------------------------------------------------
+//   selectedNotes
+//    selected notes of the visible items plus notes
+//    outside the visible area which are selected in
+//    the score
+//---------------------------------------------------------
+
+QList<Note*> PianoView::selectedNotes() const
+      {
+      QList<Note*> nl;
+      QSet<Note*> visible;
+      foreach(PianoItem* item, visibleItems) {
+            Note* note = item->note();
+            if (visible.contains(note))
+                  continue;
+            visible.insert(note);
+            if (item->isSelected())
+                  nl.append(note);
+            }
+      foreach(Note* note, index.selectedNotes()) {
+            if (!visible.contains(note))
+                  nl.append(note);
+            }
+      return nl;
+      }
+
+//---------------------------------------------------------
+//   scrollContentsBy
+//---------------------------------------------------------
+
+void PianoView::scrollContentsBy(int dx, int dy)
+      {
+      QGraphicsView::scrollContentsBy(dx, dy);
+      updateItems();
+      }
+
+//---------------------------------------------------------
+//   resizeEvent
+//---------------------------------------------------------
+
+void PianoView::resizeEvent(QResizeEvent* event)
+      {
+      QGraphicsView::resizeEvent(event);
+      updateItems();
       }
 
 //---------------------------------------------------------
@@ -463,6 +685,7 @@ void PianoView::wheelEvent(QWheelEvent* event)
             double xpos = -(mapFromScene(QPointF()).x());
             if (xpos <= 0)
                   emit xposChanged(xpos);
+            updateItems();
             }
       else if (event->modifiers() == Qt::ShiftModifier) {
             QWheelEvent we(event->pos(), event->delta(), event->buttons(), 0, Qt::Horizontal);
@@ -489,6 +712,7 @@ void PianoView::wheelEvent(QWheelEvent* event)
                         }
                   }
             emit magChanged(xmag, ymag);
+            updateItems();
             }
       }
 
@@ -522,6 +746,35 @@ int PianoView::y2pitch(int y) const
       return pitch;
       }
 
+//---------------------------------------------------------
+//   mousePressEvent
+//    a click without Ctrl starts a new selection; notes
+//    which are selected but have no item because they are
+//    scrolled out of view cannot be deselected by the
+//    scene, so drop them here
+//---------------------------------------------------------
+
+void PianoView::mousePressEvent(QMouseEvent* event)
+      {
+      if (!(event->modifiers() & Qt::ControlModifier)) {
+            QSet<Note*> visible;
+            foreach(PianoItem* item, visibleItems)
+                  visible.insert(item->note());
+            Score* score = 0;
+            foreach(Note* note, index.selectedNotes()) {
+                  if (visible.contains(note))
+                        continue;
+                  score = note->score();
+                  score->deselect(note);
+                  }
+            if (score) {
+                  score->setUpdateAll();
+                  score->end();
+                  }
+            }
+      QGraphicsView::mousePressEvent(event);
+      }
+
 //---------------------------------------------------------
 //   mouseMoveEvent
 //---------------------------------------------------------
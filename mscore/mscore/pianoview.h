@@ -28,17 +28,48 @@ class Chord;
 class Note;
 class NoteEvent;
 
+//---------------------------------------------------------
+//   NoteIndex
+//    time sorted per pitch index of the notes of a staff;
+//    piano and drum view only create graphics items for
+//    the notes found in the visible area
+//---------------------------------------------------------
+
+struct NoteIndexEntry {
+      int tick;
+      int len;
+      Note* note;
+      NoteEvent* event;
+      };
+
+typedef QPair<Note*, NoteEvent*> NoteKey;
+
+class NoteIndex {
+      QVector<NoteIndexEntry> _notes[128];
+      int _maxLen[128];                   ///< longest note of every pitch
+
+   public:
+      NoteIndex()      { clear(); }
+      void clear();
+      void append(int pitch, int tick, int len, Note*, NoteEvent* = 0);
+      void find(int pitch, int tick1, int tick2, QList<NoteIndexEntry>* list) const;
+      QList<Note*> selectedNotes() const;
+      bool isEmpty() const;
+      };
+
 //---------------------------------------------------------
 //   PianoItem
 //---------------------------------------------------------
 
 class PianoItem : public QGraphicsRectItem {
-      Note*      note;
-      NoteEvent* event;
+      Note*      _note;
+      NoteEvent* _event;
       virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0);
 
    public:
       PianoItem(Note*, NoteEvent*);
+      Note* note() const { return _note; }
+      void updateValues();
       };
 
 //---------------------------------------------------------
@@ -56,8 +87,12 @@ class PianoView : public QGraphicsView {
       int ticks;
       TType _timeType;
       int magStep;
+      NoteIndex index;
+      QHash<NoteKey, PianoItem*> visibleItems;
 
       virtual void drawBackground(QPainter* painter, const QRectF& rect);
+      void buildIndex();
+      void updateItems();
 
       int y2pitch(int y) const;
       Pos pix2pos(int x) const;
@@ -65,8 +100,11 @@ class PianoView : public QGraphicsView {
 
    protected:
       virtual void wheelEvent(QWheelEvent* event);
+      virtual void mousePressEvent(QMouseEvent* event);
       virtual void mouseMoveEvent(QMouseEvent* event);
       virtual void leaveEvent(QEvent*);
+      virtual void scrollContentsBy(int dx, int dy);
+      virtual void resizeEvent(QResizeEvent*);
 
    signals:
       void magChanged(double, double);
@@ -81,8 +119,9 @@ class PianoView : public QGraphicsView {
       PianoView();
       void setStaff(Staff*, Pos* locator);
       void setChord(Chord*, Pos* locator);
+      void updateNotes();
       void ensureVisible(int tick);
-      QList<QGraphicsItem*> items() { return scene()->selectedItems(); }
+      QList<Note*> selectedNotes() const;
       };
 
 
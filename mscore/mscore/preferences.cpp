@@ -239,6 +239,9 @@ void Preferences::init()
 
       useOsc                  = false;
       oscPort                 = 5282;
+      oscFeedbackHost         = "127.0.0.1";
+      oscFeedbackPort         = 5283;
+      oscFeedbackRate         = 0;
       appStyleFile            = ":/data/appstyle-dark.css";
       singlePalette           = false;
 
@@ -374,6 +377,9 @@ void Preferences::write()
 
       s.setValue("useOsc", useOsc);
       s.setValue("oscPort", oscPort);
+      s.setValue("oscFeedbackHost", oscFeedbackHost);
+      s.setValue("oscFeedbackPort", oscFeedbackPort);
+      s.setValue("oscFeedbackRate", oscFeedbackRate);
       s.setValue("style", styleName);
       s.setValue("singlePalette", singlePalette);
 
@@ -515,6 +521,9 @@ void Preferences::read()
 
       useOsc                 = s.value("useOsc", useOsc).toBool();
       oscPort                = s.value("oscPort", oscPort).toInt();
+      oscFeedbackHost        = s.value("oscFeedbackHost", oscFeedbackHost).toString();
+      oscFeedbackPort        = s.value("oscFeedbackPort", oscFeedbackPort).toInt();
+      oscFeedbackRate        = s.value("oscFeedbackRate", oscFeedbackRate).toInt();
       styleName              = s.value("style", styleName).toString();
       if (styleName == "light") {
             iconGroup = "icons/";
@@ -1001,6 +1010,9 @@ void PreferenceDialog::updateValues(Preferences* p)
 
       oscServer->setChecked(p->useOsc);
       oscPort->setValue(p->oscPort);
+      oscFeedbackHost->setText(p->oscFeedbackHost);
+      oscFeedbackPort->setValue(p->oscFeedbackPort);
+      oscFeedbackRate->setValue(p->oscFeedbackRate);
 
       styleName->setCurrentIndex(p->globalStyle);
 
@@ -1455,6 +1467,9 @@ void PreferenceDialog::apply()
 
       preferences.useOsc  = oscServer->isChecked();
       preferences.oscPort = oscPort->value();
+      preferences.oscFeedbackHost = oscFeedbackHost->text();
+      preferences.oscFeedbackPort = oscFeedbackPort->value();
+      preferences.oscFeedbackRate = oscFeedbackRate->value();
       if (styleName->currentIndex() == STYLE_DARK) {
             iconGroup = "icons-dark/";
             appStyleFile = ":/data/appstyle-dark.css";
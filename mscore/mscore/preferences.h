@@ -140,6 +140,9 @@ struct Preferences {
 
       bool useOsc;
       int oscPort;
+      QString oscFeedbackHost;      // where position feedback is sent to
+      int oscFeedbackPort;
+      int oscFeedbackRate;          // feedback messages per second, 0 - off
       bool singlePalette;
       QString styleName;
       int globalStyle;        // 0 - dark, 1 - light
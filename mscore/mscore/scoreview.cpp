@@ -79,6 +79,7 @@
 #include "libmscore/keysig.h"
 #include "libmscore/timesig.h"
 #include "libmscore/spanner.h"
+#include "libmscore/repeatlist.h"
 
 #include "navigator.h"
 
@@ -1465,41 +1466,16 @@ void ScoreView::moveCursor()
 
 //---------------------------------------------------------
 //   moveCursor
-//    move cursor during playback
+//    move cursor during playback; utick is the unrolled tick
 //---------------------------------------------------------
 
-void ScoreView::moveCursor(int tick)
+void ScoreView::moveCursor(int utick)
       {
-      Measure* measure = score()->tick2measure(tick);
-      if (measure == 0)
-            return;
-
       qreal x;
-      Segment* s;
-      for (s = measure->first(SegChordRest); s;) {
-            int t1 = s->tick();
-            int x1 = s->canvasPos().x();
-            qreal x2;
-            int t2;
-            Segment* ns = s->next(SegChordRest);
-            if (ns) {
-                  t2 = ns->tick();
-                  x2 = ns->canvasPos().x();
-                  }
-            else {
-                  t2 = measure->endTick();
-                  x2 = measure->canvasPos().x() + measure->width();
-                  }
-            if (tick >= t1 && tick < t2) {
-                  int   dt = t2 - t1;
-                  qreal dx = x2 - x1;
-                  x = x1 + dx * (tick-t1) / dt;
-                  break;
-                  }
-            s = ns;
-            }
-      if (s == 0)
+      Measure* measure = score()->cursorPos(utick, &x);
+      if (measure == 0)
             return;
+      int tick = score()->repeatList()->utick2tick(utick);
 
       QColor c(MScore::selectColor[0]);
       c.setAlpha(50);
@@ -2721,11 +2697,7 @@ static bool elementLower(const Element* e1, const Element* e2)
 
 Page* ScoreView::point2page(const QPointF& p)
       {
-      foreach(Page* page, score()->pages()) {
-            if (page->bbox().translated(page->pos()).contains(p))
-                  return page;
-            }
-      return 0;
+      return score()->searchPage(p);
       }
 
 //---------------------------------------------------------
@@ -2791,14 +2763,11 @@ Element* ScoreView::elementNear(QPointF p)
       int n = ll.size();
       if ((n == 0) || ((n == 1) && (ll[0]->type() == MEASURE))) {
             //
-            // if no relevant element hit, look nearby
+            // if no relevant element hit, take the closest one nearby
             //
-            foreach(const Element* e, el) {
-                  if (e->type() == PAGE || !e->selectable())
-                        continue;
-                  if (e->intersects(r))
-                        ll.append(e);
-                  }
+            Element* e = _score->nearestElement(p + page->pos(), 1.5 * w);
+            if (e)
+                  return e;
             }
       if (ll.empty()) {
             // printf("  nothing found\n");
@@ -3667,8 +3636,11 @@ void ScoreView::doDragElement(QMouseEvent* ev)
       data.hRaster = mscore->hRaster();
       data.vRaster = mscore->vRaster();
       data.pos     = pt;
-      foreach(Element* e, _score->selection().elements())
+      foreach(Element* e, _score->selection().elements()) {
+            QRectF r(e->pageBoundingRect());
             _score->addRefresh(e->drag(data));
+            _score->updateItem(e, r);
+            }
 //      _score->end();
       if (_score->playNote()) {
             Element* e = _score->selection().element();
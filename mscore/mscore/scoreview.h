@@ -297,7 +297,7 @@ class ScoreView : public QWidget, public MuseScoreView {
       void startEdit(Element*);
 
       void moveCursor(Segment*, int track);
-      void moveCursor(int tick);
+      void moveCursor(int utick);
       int cursorTick() const;
       void setCursorOn(bool);
       void setBackground(QPixmap*);
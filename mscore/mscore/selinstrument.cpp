@@ -56,6 +56,15 @@ void SelectInstrument::on_instrumentList_itemSelectionChanged()
       buttonBox->button(QDialogButtonBox::Ok)->setEnabled(flag);
       }
 
+//---------------------------------------------------------
+//   on_instrumentList_itemExpanded
+//---------------------------------------------------------
+
+void SelectInstrument::on_instrumentList_itemExpanded(QTreeWidgetItem* item)
+      {
+      populateInstrumentGroup(item);
+      }
+
 //---------------------------------------------------------
 //   on_instrumentList
 //---------------------------------------------------------
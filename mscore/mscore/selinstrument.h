@@ -37,6 +37,7 @@ class SelectInstrument : public QDialog, private Ui::SelectInstrument {
       void buildTemplateList();
       void on_instrumentList_itemSelectionChanged();
       void on_instrumentList_itemDoubleClicked(QTreeWidgetItem* item, int);
+      void on_instrumentList_itemExpanded(QTreeWidgetItem*);
 
    public:
       SelectInstrument(const Instrument&, QWidget* parent = 0);
@@ -45,12 +45,14 @@
 #include "libmscore/ottava.h"
 #include "libmscore/utils.h"
 #include "libmscore/repeatlist.h"
+#include "libmscore/dsp.h"
 #include "synthcontrol.h"
 #include "pianoroll.h"
 
 #ifdef USE_JACK
 #include "jackaudio.h"
 #endif
+#include "fileaudio.h"
 
 #ifdef AEOLUS
 #include "aeolus/aeolus/aeolus.h"
@@ -81,6 +83,7 @@ Seq::Seq()
       state    = TRANSPORT_STOP;
       driver   = 0;
       playPos  = events.constBegin();
+      playIdx  = 0;
 
       playTime  = 0;
       metronomeVolume = 0.3;
@@ -136,7 +139,8 @@ void Seq::stopWait()
 void Seq::setScoreView(ScoreView* v)
       {
       if (cv !=v && cs) {
-            cs->setSyntiState(synti->state());
+            if (running)      // synthesizer state is not known before init()
+                  cs->setSyntiState(synti->state());
             markedNotes.clear();
             stopWait();
             }
@@ -255,6 +259,42 @@ bool Seq::init()
       return true;
       }
 
+//---------------------------------------------------------
+//   renderToFile
+//    play score through the sequencer into a sound file
+//    instead of an audio device; used by the converter to
+//    check the timing of the sequencer
+//---------------------------------------------------------
+
+bool Seq::renderToFile(Score* score, const QString& path)
+      {
+#ifdef HAS_AUDIOFILE
+      FileAudio* fa = new FileAudio(this);
+      if (!fa->open(path)) {
+            delete fa;
+            return false;
+            }
+      driver   = fa;
+      cs       = score;
+      tickRest = 0;
+      tackRest = 0;
+      running  = true;
+      synti->init(MScore::sampleRate);
+      synti->setState(cs->syntiState());
+      initInstruments();
+      collectEvents();
+      setPos(0);
+      driver->startTransport();
+      bool ok = fa->render();
+      running = false;
+      driver  = 0;
+      delete fa;
+      return ok;
+#else
+      return false;
+#endif
+      }
+
 //---------------------------------------------------------
 //   exit
 //---------------------------------------------------------
@@ -383,7 +423,7 @@ void Seq::guiStop()
             cs->addRefresh(n->canvasBoundingRect());
             }
       markedNotes.clear();
-      cs->setPlayPos(cs->utime2utick(playTime) * MScore::sampleRate);
+      cs->setPlayPos(cs->utime2utick(qreal(playTime) / qreal(MScore::sampleRate)));
       cs->end();
       emit stopped();
       }
@@ -488,30 +528,41 @@ void Seq::playEvent(const Event& event)
 
 void Seq::processMessages()
       {
-      for (;;) {
-            if (toSeq.isEmpty())
-                  break;
-            SeqMsg msg = toSeq.dequeue();
-            switch(msg.id) {
-                  case SEQ_TEMPO_CHANGE:
-                        {
-                        if (playTime != 0) {
-                              int tick = cs->utime2utick(qreal(playTime) / qreal(MScore::sampleRate));
-                              cs->tempomap()->setRelTempo(msg.rdata);
-                              cs->repeatList()->update();
-                              playTime = cs->utick2utime(tick) * MScore::sampleRate;
-                              }
-                        else
-                              cs->tempomap()->setRelTempo(msg.rdata);
+      while (!toSeq.isEmpty())
+            processMessage(toSeq.dequeue());
+      while (!oscToSeq.isEmpty())
+            processMessage(oscToSeq.dequeue());
+      }
+
+//---------------------------------------------------------
+//   processMessage
+//---------------------------------------------------------
+
+void Seq::processMessage(const SeqMsg& msg)
+      {
+      switch(msg.id) {
+            case SEQ_TEMPO_CHANGE:
+                  {
+                  if (playTime != 0) {
+                        int tick = cs->utime2utick(qreal(playTime) / qreal(MScore::sampleRate));
+                        cs->tempomap()->setRelTempo(msg.rdata);
+                        cs->repeatList()->update();
+                        playTime = qRound64(cs->utick2utime(tick) * MScore::sampleRate);
                         }
-                        break;
-                  case SEQ_PLAY:
-                        putEvent(msg.event);
-                        break;
-                  case SEQ_SEEK:
-                        setPos(msg.data);
-                        break;
+                  else
+                        cs->tempomap()->setRelTempo(msg.rdata);
+                  eventFrames.setRelTempo(msg.rdata);
                   }
+                  break;
+            case SEQ_PLAY:
+                  putEvent(msg.event);
+                  break;
+            case SEQ_SEEK:
+                  setPos(msg.data);
+                  break;
+            case SEQ_GAIN:
+                  synti->setGain(msg.rdata);
+                  break;
             }
       }
 
@@ -578,14 +629,14 @@ void Seq::process(unsigned n, float* lbuffer, float* rbuffer)
             // play events for one segment
             //
             unsigned framePos = 0;
-            int endTime = playTime + frames;
-            for (; playPos != events.constEnd(); ++playPos) {
-                  int f = cs->utick2utime(playPos.key()) * MScore::sampleRate;
+            qint64 endTime = playTime + frames;
+            for (; playPos != events.constEnd(); ++playPos, ++playIdx) {
+                  qint64 f = eventFrames.frame(playIdx);
                   if (f >= endTime)
                         break;
                   int n = f - playTime;
                   if (n < 0) {
-                        printf("%d:  %d - %d\n", playPos.key(), f, playTime);
+                        printf("%d:  %lld - %lld\n", playPos.key(), f, playTime);
 				n = 0;
                         }
                   metronome(n, l, r);
@@ -618,18 +669,8 @@ void Seq::process(unsigned n, float* lbuffer, float* rbuffer)
       //
       // metering
       //
-      int k = 0;
-      float lv = 0.0f;
-      float rv = 0.0f;
-      for (unsigned i = 0; i < n; ++i) {
-            float val = fabs(lbuffer[k]);
-            if (lv < val)
-                  lv = val;
-            val = fabs(rbuffer[k]);
-            if (rv < val)
-                  rv = val;
-            k++;
-            }
+      float lv = dsp->peak(lbuffer, n, 0.0f);
+      float rv = dsp->peak(rbuffer, n, 0.0f);
       meterValue[0] = lv;
       meterValue[1] = rv;
       if (meterPeakValue[0] < lv) {
@@ -668,6 +709,7 @@ void Seq::collectEvents()
       events.clear();
 
       cs->toEList(&events);
+      eventFrames.init(cs, events.keys());
       endTick = 0;
       if (!events.empty()) {
             EventMap::const_iterator e = events.constEnd();
@@ -746,8 +788,9 @@ void Seq::setPos(int utick)
       {
       stopNotes();
 
-      playTime  = cs->utick2utime(utick) * MScore::sampleRate;
+      playTime  = qRound64(cs->utick2utime(utick) * MScore::sampleRate);
       playPos   = events.lowerBound(utick);
+      playIdx   = eventFrames.index(utick);
       guiPos    = playPos;
       }
 
@@ -761,9 +804,9 @@ void Seq::seek(int tick)
       if (cs == 0)
             return;
       Segment* seg = cs->tick2segment(tick);
-      if (seg) {
-            mscore->currentScoreView()->moveCursor(seg, -1);
-            }
+      ScoreView* v = mscore->currentScoreView();
+      if (seg && v)                 // no view when run from the converter
+            v->moveCursor(seg, -1);
       cs->setPlayPos(tick);
       cs->setLayoutAll(false);
       cs->end();
@@ -988,6 +1031,44 @@ void Seq::guiToSeq(const SeqMsg& msg)
       toSeq.enqueue(msg);
       }
 
+#ifdef OSC
+//---------------------------------------------------------
+//   oscTempo
+//    called in the osc handler thread; the tempo change
+//    goes straight to the sequencer without a round trip
+//    through the gui event loop
+//    val = 0 - 127, 64 ~ normal tempo
+//---------------------------------------------------------
+
+void Seq::oscTempo(int val)
+      {
+      if (!driver || !running)
+            return;
+      val = qBound(0, val, 127);
+      SeqMsg msg;
+      msg.rdata = (val * 240 / 128) * .01;
+      msg.id    = SEQ_TEMPO_CHANGE;
+      oscToSeq.enqueue(msg);
+      }
+
+//---------------------------------------------------------
+//   oscVolume
+//    called in the osc handler thread; like the tempo, the
+//    gain is set by the sequencer thread
+//---------------------------------------------------------
+
+void Seq::oscVolume(int val)
+      {
+      if (!driver || !running)
+            return;
+      SeqMsg msg;
+      msg.rdata = val / 128.0;
+      msg.id    = SEQ_GAIN;
+      oscToSeq.enqueue(msg);
+      emit gainChanged(msg.rdata);  // queued to the gui thread
+      }
+#endif
+
 //---------------------------------------------------------
 //   eventToGui
 //---------------------------------------------------------
@@ -1167,7 +1248,7 @@ void Seq::heartBeat()
             }
 
       int tick = cs->repeatList()->utick2tick(guiPos.key());
-      mscore->currentScoreView()->moveCursor(tick);
+      mscore->currentScoreView()->moveCursor(guiPos.key());
       mscore->setPos(tick);
       if (pp)
             pp->heartBeat(tick, playPos.key());
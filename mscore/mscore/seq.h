@@ -22,6 +22,7 @@
 #define __SEQ_H__
 
 #include "libmscore/event.h"
+#include "libmscore/eventframes.h"
 #include "driver.h"
 #include "libmscore/fifo.h"
 #include "libmscore/tempo.h"
@@ -43,7 +44,7 @@ class MasterSynth;
 //---------------------------------------------------------
 
 enum { SEQ_NO_MESSAGE, SEQ_TEMPO_CHANGE, SEQ_PLAY, SEQ_SEEK,
-       SEQ_MIDI_INPUT_EVENT
+       SEQ_MIDI_INPUT_EVENT, SEQ_GAIN
       };
 
 struct SeqMsg {
@@ -85,6 +86,7 @@ class Seq : public QObject {
       bool playlistChanged;
 
       SeqMsgFifo toSeq;
+      SeqMsgFifo oscToSeq;                // written only by the osc handler thread
       SeqMsgFifo fromSeq;
       Driver* driver;
 
@@ -93,10 +95,12 @@ class Seq : public QObject {
       int peakTimer[2];
 
       EventMap events;                    // playlist
+      EventFrames eventFrames;            // frame position of every event in events
 
-      int playTime;                       // current play position in samples
+      qint64 playTime;                    // current play position in samples
 
       EventMap::const_iterator playPos;   // moved in real time thread
+      int playIdx;                        // index of playPos in eventFrames
       EventMap::const_iterator guiPos;    // moved in gui thread
       QList<const Note*> markedNotes;     // notes marked as sounding
 
@@ -116,6 +120,7 @@ class Seq : public QObject {
       void setPos(int);
       void playEvent(const Event&);
       void guiToSeq(const SeqMsg& msg);
+      void processMessage(const SeqMsg& msg);
       void metronome(unsigned n, float* l, float* r);
 
    private slots:
@@ -131,6 +136,10 @@ class Seq : public QObject {
       void stopNotes();
       void start();
       void stop();
+#ifdef OSC
+      void oscTempo(int);
+      void oscVolume(int);
+#endif
 
    signals:
       void started();
@@ -159,6 +168,7 @@ class Seq : public QObject {
 
       bool init();
       void exit();
+      bool renderToFile(Score*, const QString& path);
       bool isRunning() const    { return running; }
       bool isPlaying() const    { return state == TRANSPORT_PLAY; }
       bool isStopped() const    { return state == TRANSPORT_STOP; }
@@ -0,0 +1,107 @@
+//=============================================================================
+//  MuseScore
+//  Linux Music Score Editor
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//=============================================================================
+
+#include <sys/time.h>
+#include <time.h>
+#include "libmscore/mscore.h"
+#include "starttrace.h"
+
+QList<StartTrace::Phase> StartTrace::phases;
+QList<int> StartTrace::open;
+QString StartTrace::path;
+
+//---------------------------------------------------------
+//   now
+//    usec since the first call
+//---------------------------------------------------------
+
+qint64 StartTrace::now()
+      {
+#if defined (__MINGW32__) || defined (__APPLE__)
+      struct timeval t;
+      gettimeofday(&t, 0);
+      qint64 usec = qint64(t.tv_sec) * 1000000 + t.tv_usec;
+#else
+      struct timespec t;
+      clock_gettime(CLOCK_MONOTONIC, &t);
+      qint64 usec = qint64(t.tv_sec) * 1000000 + t.tv_nsec / 1000;
+#endif
+      static qint64 startTime = usec;
+      return usec - startTime;
+      }
+
+//---------------------------------------------------------
+//   begin
+//    phases nest; they are only recorded from the
+//    gui thread
+//---------------------------------------------------------
+
+void StartTrace::begin(const char* name)
+      {
+      Phase p;
+      p.name     = name;
+      p.start    = now();
+      p.duration = 0;
+      open.append(phases.size());
+      phases.append(p);
+      }
+
+//---------------------------------------------------------
+//   end
+//    finish the innermost phase
+//---------------------------------------------------------
+
+void StartTrace::end()
+      {
+      if (open.isEmpty()) {
+            printf("StartTrace::end(): no phase\n");
+            return;
+            }
+      Phase& p  = phases[open.takeLast()];
+      p.duration = now() - p.start;
+      if (debugMode)
+            printf("startup: %-24s %8.2f ms\n", p.name, p.duration / 1000.0);
+      }
+
+//---------------------------------------------------------
+//   write
+//    write all phases as "complete" events
+//---------------------------------------------------------
+
+void StartTrace::write()
+      {
+      if (path.isEmpty())
+            return;
+      QFile f(path);
+      if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            printf("cannot write startup trace <%s>: %s\n", qPrintable(path), qPrintable(f.errorString()));
+            return;
+            }
+      QTextStream os(&f);
+      os << "{\"traceEvents\":[\n";
+      for (int i = 0; i < phases.size(); ++i) {
+            const Phase& p = phases[i];
+            os << QString("{\"name\":\"%1\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":%2,\"dur\":%3,\"pid\":1,\"tid\":1}")
+                  .arg(p.name).arg(p.start).arg(p.duration);
+            os << (i + 1 < phases.size() ? ",\n" : "\n");
+            }
+      os << "],\"displayTimeUnit\":\"ms\"}\n";
+      }
+
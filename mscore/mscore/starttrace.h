@@ -0,0 +1,51 @@
+//=============================================================================
+//  MuseScore
+//  Linux Music Score Editor
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//=============================================================================
+
+#ifndef __STARTTRACE_H__
+#define __STARTTRACE_H__
+
+//---------------------------------------------------------
+//   StartTrace
+//    records begin and duration of the initialization
+//    phases; with "mscore -T file" they are written to
+//    file in the Chrome trace event format, to be viewed
+//    with chrome://tracing
+//---------------------------------------------------------
+
+class StartTrace {
+      struct Phase {
+            const char* name;
+            qint64 start;           ///< usec since program start
+            qint64 duration;        ///< usec
+            };
+      static QList<Phase> phases;
+      static QList<int> open;       ///< indices of unfinished phases
+      static QString path;
+
+   public:
+      static void setPath(const QString& s) { path = s; }
+      static qint64 now();
+      static void begin(const char* name);
+      static void end();
+      static void write();
+      };
+
+#endif
+
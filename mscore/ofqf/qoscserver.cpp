@@ -25,12 +25,19 @@ QOscServer::QOscServer( quint16 port, QObject* p )
 	//qDebug() << " socket() gives" << socket();
 	socket()->bind( QHostAddress::Any, port );
 	connect( socket(), SIGNAL( readyRead() ), this, SLOT( readyRead() ) );
+	scheduleTimer = new QTimer( this );
+	scheduleTimer->setSingleShot( true );
+	connect( scheduleTimer, SIGNAL( timeout() ), this, SLOT( dispatchScheduled() ) );
 }
 QOscServer::QOscServer( QHostAddress address, quint16 port, QObject* p )
 	: QOscBase( p )
 {
 	//qDebug() << "QOscServer::QOscServer(" << address << "," << port << "," << p << ")";
 	socket()->bind( address, port );
+	connect( socket(), SIGNAL( readyRead() ), this, SLOT( readyRead() ) );
+	scheduleTimer = new QTimer( this );
+	scheduleTimer->setSingleShot( true );
+	connect( scheduleTimer, SIGNAL( timeout() ), this, SLOT( dispatchScheduled() ) );
 }
 
 QOscServer::~QOscServer() {
@@ -44,103 +51,167 @@ void QOscServer::unregisterPathObject( PathObject* p ) {
 	paths.removeAll( p );
 }
 
-#define BUFFERSIZE 255
-
-void QOscServer::readyRead() 
-      {
-	    //qDebug() << "QOscServer::readyRead()";
-	    while ( socket()->hasPendingDatagrams() ) {
-      QByteArray fullData( BUFFERSIZE, char( 0 ) );
-		  int size = socket()->readDatagram( fullData.data(), BUFFERSIZE );
-		  //qDebug() << " read" << size << "(" << fullData.size() << ") bytes:" << fullData; 
-      //printf("%s\n", qPrintable(QString(fullData.toHex())));     
-    
-      QList<QByteArray> list;
-      if(fullData.left(7) == "#bundle") {
-            int k = 16;
-            while (k < size) {
-                  int chunkSize = toInt32(fullData.mid(k, 4));
-                  QByteArray dataChunk = fullData.mid( k+4 , chunkSize);
-                  //qDebug() << " readchunk" << chunkSize << "(" << dataChunk.size() << ") bytes:" << dataChunk;
-                  list.append(dataChunk);
-                  if (chunkSize == 0)
-                        break;
-                  k += (chunkSize + 4);
-                  }
-            }
-      else {
-            list.append(fullData);
-            }
-    
-    	QString path;
-    	QString args;
-    	QVariant arguments;
-      for (int index = 0; index < list.size(); ++index) {
-            QByteArray data = list.at(index);
-            int i = 0;
-        		if ( data[ i ] == '/' ) {
-        		      for ( ; i<size && data[ i ] != char( 0 ); ++i )
-        		            path += data[ i ];
-        
-        			    while ( data[ i ] != ',' ) ++i;
-        			    ++i;
-        		      while ( data[ i ] != char( 0 ) )
-        		            args += data[ i++ ];
-        
-        			    if ( ! args.isEmpty() ) {
-        				        QList<QVariant> list;
-        				        foreach( QChar type, args ) {
-        					            while ( i%4 != 0 ) ++i;
-        					            //qDebug() << i << "\ttrying to convert to" << type;
-        
-        					            QByteArray tmp = data.right( data.size()-i );
-        					            QVariant value;
-                              if ( type == 's' ) {
-        						                QString s = toString( tmp );
-        						                value = s;
-                                    i += s.size();
-                                    }
-                              if ( type == 'i' ) {
-                                    value = toInt32( tmp );
-                                    i+=4;
-                                    }
-                              if ( type == 'f' ) {
-                                    value = toFloat( tmp );
-                                    i+=4;
-                                    }
-                              //qDebug() << " got" << value;
-        
-                              if ( args.size() > 1 )
-                                    list.append( value );
-                              else
-                                    arguments = value;
-                              }
-        
-                              if ( args.size() > 1 )
-                                    arguments = list;
-                        }
-        		      }
-        		      qDebug() << "path seems to be" << path << "args are" << args << ":" << arguments;
-        
-              		QMap<QString,QString> replacements;
-              		replacements[ "!" ] = "^";
-              		replacements[ "{" ] = "(";
-              		replacements[ "}" ] = ")";
-              		replacements[ "," ] = "|";
-              		replacements[ "*" ] = ".*";
-              		replacements[ "?" ] = ".";
-              
-              		foreach( QString rep, replacements.keys() )
-              			path.replace( rep, replacements[ rep ] );
-              
-              		//qDebug() << " after transformation to OSC-RegExp path is" << path;
-              
-              		QRegExp exp( path );
-              		foreach( PathObject* obj, paths ) {
-              		      if ( exp.exactMatch( obj->_path ) )
-              				        obj->signalData( arguments );
-              		      }
-              		}
-            }
-      }
+// seconds between 1900-01-01 (osc/ntp epoch) and 1970-01-01
+#define NTP_UNIX_OFFSET 2208988800ULL
+
+// timetag meaning "immediately"
+#define TIMETAG_NOW 1ULL
+
+// bundles scheduled further into the future (in seconds) are dropped
+#define SCHEDULE_HORIZON 3600ULL
+
+quint64 QOscServer::toTimeTag( const QByteArray& b ) {
+	quint64 hi = quint32( toInt32( b ) );
+	quint64 lo = quint32( toInt32( b.mid( 4, 4 ) ) );
+	return ( hi << 32 ) | lo;
+}
+
+quint64 QOscServer::currentTimeTag() {
+	QDateTime now = QDateTime::currentDateTime().toUTC();
+	quint64 sec  = quint64( now.toTime_t() ) + NTP_UNIX_OFFSET;
+	quint64 frac = ( quint64( now.time().msec() ) << 32 ) / 1000;
+	return ( sec << 32 ) | frac;
+}
+
+void QOscServer::readyRead() {
+	//qDebug() << "QOscServer::readyRead()";
+	while ( socket()->hasPendingDatagrams() ) {
+		QByteArray fullData( int( socket()->pendingDatagramSize() ), char( 0 ) );
+		int size = socket()->readDatagram( fullData.data(), fullData.size() );
+		if ( size <= 0 )
+			continue;
+		fullData.resize( size );
+		//qDebug() << " read" << size << "bytes:" << fullData;
+		parsePacket( fullData, TIMETAG_NOW );
+	}
+	if ( !scheduled.isEmpty() )
+		dispatchScheduled();
+}
+
+void QOscServer::parsePacket( const QByteArray& data, quint64 timetag ) {
+	if ( !data.startsWith( "#bundle" ) ) {
+		if ( timetag == TIMETAG_NOW )
+			dispatchMessage( data );
+		else
+			scheduled.insertMulti( timetag, data );
+		return;
+	}
+	if ( data.size() < 16 )
+		return;
+	quint64 tag = toTimeTag( data.mid( 8, 8 ) );
+	if ( tag == TIMETAG_NOW )
+		tag = timetag;
+	else if ( tag > currentTimeTag() + ( SCHEDULE_HORIZON << 32 ) )
+		return;
+	int k = 16;
+	while ( k + 4 <= data.size() ) {
+		int chunkSize = toInt32( data.mid( k, 4 ) );
+		if ( chunkSize <= 0 || k + 4 + chunkSize > data.size() )
+			break;
+		//qDebug() << " readchunk" << chunkSize << "bytes";
+		parsePacket( data.mid( k + 4, chunkSize ), tag );
+		k += chunkSize + 4;
+	}
+}
+
+/**
+ * Dispatch all scheduled messages which are due and restart the timer
+ * for the next one. Messages of a bundle keep their order because
+ * insertMulti() puts equal keys in front of each other and we walk
+ * them backwards.
+ */
+void QOscServer::dispatchScheduled() {
+	quint64 now = currentTimeTag();
+	while ( !scheduled.isEmpty() ) {
+		QMap<quint64, QByteArray>::iterator it = scheduled.begin();
+		quint64 tag = it.key();
+		if ( tag > now ) {
+			// split seconds and fraction, ( tag - now ) * 1000
+			// overflows for timetags more than 49 days ahead
+			quint64 d  = tag - now;
+			quint64 ms = ( d >> 32 ) * 1000 + ( ( ( d & 0xffffffffULL ) * 1000 ) >> 32 );
+			if ( ms > SCHEDULE_HORIZON * 1000 )
+				ms = SCHEDULE_HORIZON * 1000;
+			scheduleTimer->start( int( ms ) );
+			return;
+		}
+		QList<QByteArray> due = scheduled.values( tag );
+		scheduled.remove( tag );
+		for ( int i = due.size() - 1; i >= 0; --i )
+			dispatchMessage( due[ i ] );
+	}
+}
+
+void QOscServer::dispatchMessage( const QByteArray& msg ) {
+	int size = msg.size();
+	if ( size == 0 || msg[ 0 ] != '/' )
+		return;
+
+	QString path;
+	QString args;
+	QVariant arguments;
+	int i = 0;
+	for ( ; i<size && msg[ i ] != char( 0 ); ++i )
+		path += msg[ i ];
+
+	while ( i < size && msg[ i ] != ',' ) ++i;
+	++i;
+	while ( i < size && msg[ i ] != char( 0 ) )
+		args += msg[ i++ ];
+
+	if ( ! args.isEmpty() ) {
+		QList<QVariant> list;
+		foreach( QChar type, args ) {
+			while ( i%4 != 0 ) ++i;
+			if ( i >= size )
+				break;
+			//qDebug() << i << "\ttrying to convert to" << type;
+
+			QByteArray tmp = msg.right( size-i );
+			QVariant value;
+			if ( type == 's' ) {
+				QString s = toString( tmp );
+				value = s;
+				i += s.toUtf8().size() + 1;
+			}
+			if ( type == 'i' ) {
+				value = toInt32( tmp );
+				i+=4;
+			}
+			if ( type == 'f' ) {
+				value = toFloat( tmp );
+				i+=4;
+			}
+			//qDebug() << " got" << value;
+
+			if ( args.size() > 1 )
+				list.append( value );
+			else
+				arguments = value;
+		}
+
+		if ( args.size() > 1 )
+			arguments = list;
+	}
+	//qDebug() << "path seems to be" << path << "args are" << args << ":" << arguments;
+
+	QMap<QString,QString> replacements;
+	replacements[ "!" ] = "^";
+	replacements[ "{" ] = "(";
+	replacements[ "}" ] = ")";
+	replacements[ "," ] = "|";
+	replacements[ "*" ] = ".*";
+	replacements[ "?" ] = ".";
+
+	foreach( QString rep, replacements.keys() )
+		path.replace( rep, replacements[ rep ] );
+
+	//qDebug() << " after transformation to OSC-RegExp path is" << path;
+
+	QRegExp exp( path );
+	foreach( PathObject* obj, paths ) {
+		if ( exp.exactMatch( obj->_path ) )
+			obj->signalData( arguments );
+	}
+}
 
@@ -60,11 +60,27 @@ class QOscServer : public QOscBase
 
 	private slots:
 		void readyRead();
+		void dispatchScheduled();
 	private:
 
 		void registerPathObject( PathObject* );
 		void unregisterPathObject( PathObject* );
 		QList<PathObject*> paths;
+
+		/**
+		 * @brief Split a packet into its messages
+		 *
+		 * Bundles may be nested, an inner bundle inherits the timetag of
+		 * the outer one if its own is "immediately".
+		 */
+		void parsePacket( const QByteArray&, quint64 timetag );
+		void dispatchMessage( const QByteArray& );
+		static quint64 toTimeTag( const QByteArray& );
+		static quint64 currentTimeTag();
+
+		/// messages from bundles whose timetag lies in the future
+		QMap<quint64, QByteArray> scheduled;
+		QTimer* scheduleTimer;
 };
 
 #endif // QOSCSERVER_H
@@ -33,6 +33,7 @@
 #include "libmscore/segment.h"
 #include "libmscore/keysig.h"
 #include "libmscore/system.h"
+#include "libmscore/repeatlist.h"
 
 #include "seq.h"
 
@@ -271,40 +272,16 @@ void ScoreView::setTempo(qreal val)
 
 //---------------------------------------------------------
 //   moveCursor
+//    utick is the unrolled tick
 //---------------------------------------------------------
 
-void ScoreView::moveCursor(int tick)
+void ScoreView::moveCursor(int utick)
       {
-      Measure* measure = score->tick2measure(tick);
-      if (measure == 0)
-            return;
-
       qreal x;
-      Segment* s;
-      for (s = measure->first(SegChordRest); s;) {
-            int t1 = s->tick();
-            int x1 = s->canvasPos().x();
-            qreal x2;
-            int t2;
-            Segment* ns = s->next(SegChordRest);
-            if (ns) {
-                  t2 = ns->tick();
-                  x2 = ns->canvasPos().x();
-                  }
-            else {
-                  t2 = measure->endTick();
-                  x2 = measure->canvasPos().x() + measure->width();
-                  }
-            if (tick >= t1 && tick < t2) {
-                  int   dt = t2 - t1;
-                  qreal dx = x2 - x1;
-                  x = x1 + dx * (tick-t1) / dt;
-                  break;
-                  }
-            s = ns;
-            }
-      if (s == 0)
+      Measure* measure = score->cursorPos(utick, &x);
+      if (measure == 0)
             return;
+      int tick = score->repeatList()->utick2tick(utick);
 
       QColor c(MScore::selectColor[0]);
       c.setAlpha(50);
@@ -93,7 +93,7 @@ class ScoreView : public QDeclarativeItem, public MuseScoreView {
       void setParentWidth(qreal val)  { _parentWidth = val;   }
       qreal parentHeight() const      { return _parentHeight; }
       void setParentHeight(qreal val) { _parentHeight = val;  }
-      void moveCursor(int);
+      void moveCursor(int utick);
       };
 
 
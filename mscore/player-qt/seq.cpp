@@ -58,7 +58,8 @@ Seq::Seq()
       driver   = 0;
       running  = false;
       playPos  = events.constBegin();
-      playTime = 0.0;
+      playIdx  = 0;
+      playTime = 0;
       cs       = 0;
       state    = TRANSPORT_STOP;
       playlistChanged = false;
@@ -183,14 +184,16 @@ void Seq::processMessages()
             switch(msg.id) {
                   case SEQ_TEMPO_CHANGE:
                         if (playTime != 0) {
-                              int tick = cs->utime2utick(playTime);
+                              int tick = cs->utime2utick(qreal(playTime) / qreal(MScore::sampleRate));
                               cs->tempomap()->setRelTempo(msg.data.realVal);
                               cs->repeatList()->update();
-                              playTime = cs->utick2utime(tick);
-                              startTime = curTime() - playTime;
+                              qreal t   = cs->utick2utime(tick);
+                              playTime  = qRound64(t * MScore::sampleRate);
+                              startTime = curTime() - t;
                               }
                         else
                               cs->tempomap()->setRelTempo(msg.data.realVal);
+                        eventFrames.setRelTempo(msg.data.realVal);
                         break;
                   case SEQ_PLAY:
                         putEvent(msg.event);
@@ -212,16 +215,18 @@ void Seq::process(unsigned n, float* p)
       processMessages();
       if (state == TRANSPORT_PLAY) {
             unsigned framePos = 0;
-            qreal endTime = playTime + qreal(frames)/qreal(MScore::sampleRate);
-            for (; playPos != events.constEnd(); ++playPos) {
-                  qreal f = cs->utick2utime(playPos.key());
+            qint64 endTime = playTime + frames;
+            for (; playPos != events.constEnd(); ++playPos, ++playIdx) {
+                  qint64 f = eventFrames.frame(playIdx);
                   if (f >= endTime)
                         break;
-                  int n = lrint((f - playTime) * MScore::sampleRate);
+                  int n = f - playTime;
+                  if (n < 0)
+                        n = 0;
 
                   synti->process(n, p);
                   p += 2 * n;
-                  playTime += qreal(n)/qreal(MScore::sampleRate);
+                  playTime += n;
 
                   frames    -= n;
                   framePos  += n;
@@ -230,7 +235,7 @@ void Seq::process(unsigned n, float* p)
                   }
             if (frames) {
                   synti->process(frames, p);
-                  playTime += qreal(frames)/qreal(MScore::sampleRate);
+                  playTime += frames;
                   }
             if (playPos == events.constEnd()) {
                   driver->stopTransport();
@@ -318,9 +323,11 @@ void Seq::setPos(int utick)
             }
       activeNotes.clear();
 
-      playTime  = cs->utick2utime(utick);
-      startTime = curTime() - playTime;
+      qreal t   = cs->utick2utime(utick);
+      playTime  = qRound64(t * MScore::sampleRate);
+      startTime = curTime() - t;
       playPos   = events.lowerBound(utick);
+      playIdx   = eventFrames.index(utick);
       guiPos    = playPos;
       }
 
@@ -357,6 +364,7 @@ void Seq::collectEvents()
       activeNotes.clear();
 
       cs->toEList(&events);
+      eventFrames.init(cs, events.keys());
       endTick = 0;
       if (!events.empty()) {
             EventMap::const_iterator e = events.constEnd();
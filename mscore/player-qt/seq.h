@@ -23,6 +23,7 @@
 
 #include "m-msynth/event.h"
 #include "libmscore/fifo.h"
+#include "libmscore/eventframes.h"
 // #include "libmscore/painter.h"
 
 class Synti;
@@ -85,16 +86,18 @@ class Seq : public QObject {
       Synti* synti;
       Driver* driver;
 
-      qreal playTime;
+      qint64 playTime;                    // current play position in frames
       qreal startTime;
       int endTick;
       int playTick;
 
       EventMap::const_iterator playPos;   // moved in real time thread
+      int playIdx;                        // index of playPos in eventFrames
       EventMap::const_iterator guiPos;
       QList<SeqEvent> activeNotes;        // notes sounding
 
       EventMap events;
+      EventFrames eventFrames;            // frame position of every event in events
       QList<SeqEvent> eventList;
       void sendMessage(SeqMsg&) const;
       void processMessages();
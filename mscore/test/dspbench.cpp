@@ -0,0 +1,199 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2011 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//=============================================================================
+
+//
+//    microbenchmark of the dsp kernels in libmscore/dsp.cpp:
+//    compares the generic routines with the ones selected by
+//    initDsp() and checks that both compute the same result
+//
+//    built and run by "benchmark dsp"
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "libmscore/dsp.h"
+
+static const unsigned N      = 1023;        // odd, to exercise the scalar tail
+static const int      LOOPS  = 20000;
+
+static float src[2 * N];
+static float l[N], r[N];
+static float dst[2 * N];
+static int   idst[N];
+
+static int failures = 0;
+
+//---------------------------------------------------------
+//   now
+//    time in microseconds
+//---------------------------------------------------------
+
+static double now()
+      {
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return tv.tv_sec * 1e6 + tv.tv_usec;
+      }
+
+//---------------------------------------------------------
+//   fill
+//    deterministic samples in -1.5 - 1.5, so that
+//    floatToInt clips some of them
+//---------------------------------------------------------
+
+static void fill()
+      {
+      srand(1);
+      for (unsigned i = 0; i < 2 * N; ++i)
+            src[i] = (rand() / float(RAND_MAX)) * 3.0f - 1.5f;
+      for (unsigned i = 0; i < N; ++i) {
+            l[i] = src[i];
+            r[i] = src[N + i];
+            }
+      }
+
+//---------------------------------------------------------
+//   same
+//---------------------------------------------------------
+
+static bool same(const float* a, const float* b, unsigned n)
+      {
+      for (unsigned i = 0; i < n; ++i) {
+            if (fabsf(a[i] - b[i]) > 1e-6f)
+                  return false;
+            }
+      return true;
+      }
+
+static bool same(const int* a, const int* b, unsigned n)
+      {
+      for (unsigned i = 0; i < n; ++i) {
+            if (a[i] != b[i])
+                  return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   run
+//    time LOOPS calls of kernel k of Dsp d; return ns per
+//    sample and leave the result of one call in dst/idst
+//---------------------------------------------------------
+
+enum { PEAK, GAIN, MIX_GAIN, MIX, INTERLEAVE, DEINTERLEAVE, FLOAT_TO_INT, KERNELS };
+
+static const char* kernelNames[KERNELS] = {
+      "peak", "applyGainToBuffer", "mixWithGain", "mix",
+      "interleave", "deinterleave", "floatToInt"
+      };
+
+static float peakResult;
+
+static void call(Dsp* d, int k)
+      {
+      switch(k) {
+            case PEAK:
+                  peakResult = d->peak(src, N, 0.0f);
+                  break;
+            case GAIN:
+                  d->applyGainToBuffer(dst, N, 0.999f);
+                  break;
+            case MIX_GAIN:
+                  d->mixWithGain(dst, src, N, 0.5f);
+                  break;
+            case MIX:
+                  d->mix(dst, src, N);
+                  break;
+            case INTERLEAVE:
+                  d->interleave(dst, l, r, N);
+                  break;
+            case DEINTERLEAVE:
+                  d->deinterleave(dst, dst + N, src, N);
+                  break;
+            case FLOAT_TO_INT:
+                  d->floatToInt(idst, src, N, 0x7fff);
+                  break;
+            }
+      }
+
+static double run(Dsp* d, int k)
+      {
+      for (unsigned i = 0; i < 2 * N; ++i)
+            dst[i] = src[i];
+      double start = now();
+      for (int i = 0; i < LOOPS; ++i) {
+            call(d, k);
+            if (k == GAIN || k == MIX_GAIN || k == MIX) {
+                  // keep the values bounded
+                  if ((i & 63) == 63) {
+                        for (unsigned j = 0; j < N; ++j)
+                              dst[j] = src[j];
+                        }
+                  }
+            }
+      double t = now() - start;
+      // one more call on fresh data for the comparison
+      for (unsigned i = 0; i < 2 * N; ++i)
+            dst[i] = src[i];
+      call(d, k);
+      return t * 1000.0 / (double(LOOPS) * N);
+      }
+
+//---------------------------------------------------------
+//   main
+//---------------------------------------------------------
+
+int main()
+      {
+      fill();
+      initDsp();
+      Dsp* generic = new Dsp;
+      printf("dsp kernels, %d samples, %s against generic\n", N, dsp->name());
+
+      static float  rdst[2 * N];
+      static int    ridst[N];
+      for (int k = 0; k < KERNELS; ++k) {
+            double tg = run(generic, k);
+            float gpeak = peakResult;
+            for (unsigned i = 0; i < 2 * N; ++i)
+                  rdst[i] = dst[i];
+            for (unsigned i = 0; i < N; ++i)
+                  ridst[i] = idst[i];
+            double td = run(dsp, k);
+
+            bool ok;
+            if (k == PEAK)
+                  ok = gpeak == peakResult;
+            else if (k == FLOAT_TO_INT)
+                  ok = same(ridst, idst, N);
+            else
+                  ok = same(rdst, dst, 2 * N);
+            printf("%-20s %6.3f ns %6.3f ns %5.1fx", kernelNames[k], tg, td, td > 0.0 ? tg / td : 0.0);
+            if (ok)
+                  printf("\n");
+            else {
+                  printf("  FAILED (results differ)\n");
+                  ++failures;
+                  }
+            }
+      delete generic;
+      return failures ? 1 : 0;
+      }
@@ -158,6 +158,10 @@ Zip::Zip()
       {
 	headers = 0;
 	device  = 0;
+      curEntry = 0;
+      zstr     = 0;
+      entryFailed = false;
+      writeFailed = false;
 
 	// keep an unsigned pointer so we avoid to over bloat the code with casts
 	uBuffer  = (uchar*) buffer1;
@@ -211,6 +215,8 @@ bool Zip::createArchive(QIODevice* dev)
 		      }
 	      }
 	headers = new QMap<QString,ZipEntryP*>;
+      entryFailed = false;
+      writeFailed = false;
 	return true;
       }
 
@@ -242,89 +248,9 @@ bool Zip::createEntry(const QString& entryName,
             }
 
 	// create header and store it to write a central directory later
-	ZipEntryP* h = new ZipEntryP;
-
-	h->compMethod = (level == 0) ? 0 : 0x0008;
-
-	QDate d = dt.date();
-	h->modDate[1] = ((d.year() - 1980) << 1) & 254;
-	h->modDate[1] |= ((d.month() >> 3) & 1);
-	h->modDate[0] = ((d.month() & 7) << 5) & 224;
-	h->modDate[0] |= d.day();
-
-	QTime t = dt.time();
-	h->modTime[1] = (t.hour() << 3) & 248;
-	h->modTime[1] |= ((t.minute() >> 3) & 7);
-	h->modTime[0] = ((t.minute() & 7) << 5) & 224;
-	h->modTime[0] |= t.second() / 2;
-
-	h->szUncomp = dirOnly ? 0 : actualFile.size();
-
-	// **** Write local file header ****
-
-	// signature
-	buffer1[0] = 'P'; buffer1[1] = 'K';
-	buffer1[2] = 0x3; buffer1[3] = 0x4;
-
-	// version needed to extract
-	buffer1[ZIP_LH_OFF_VERS] = ZIP_VERSION;
-	buffer1[ZIP_LH_OFF_VERS + 1] = 0;
-
-	// general purpose flag
-	buffer1[ZIP_LH_OFF_GPFLAG] = h->gpFlag[0];
-	buffer1[ZIP_LH_OFF_GPFLAG + 1] = h->gpFlag[1];
-
-	// compression method
-	buffer1[ZIP_LH_OFF_CMET] = h->compMethod & 0xFF;
-	buffer1[ZIP_LH_OFF_CMET + 1] = (h->compMethod>>8) & 0xFF;
-
-	// last mod file time
-	buffer1[ZIP_LH_OFF_MODT] = h->modTime[0];
-	buffer1[ZIP_LH_OFF_MODT + 1] = h->modTime[1];
-
-	// last mod file date
-	buffer1[ZIP_LH_OFF_MODD] = h->modDate[0];
-	buffer1[ZIP_LH_OFF_MODD + 1] = h->modDate[1];
-
-	// skip crc (4bytes) [14,15,16,17]
-
-	// skip compressed size but include evtl. encryption header (4bytes: [18,19,20,21])
-	buffer1[ZIP_LH_OFF_CSIZE] =
-	buffer1[ZIP_LH_OFF_CSIZE + 1] =
-	buffer1[ZIP_LH_OFF_CSIZE + 2] =
-	buffer1[ZIP_LH_OFF_CSIZE + 3] = 0;
-
-	h->szComp = 0;
-
-	// uncompressed size [22,23,24,25]
-	setULong(h->szUncomp, buffer1, ZIP_LH_OFF_USIZE);
-
-	// filename length
-	QByteArray entryNameBytes = entryName.toUtf8();
-	int sz = entryNameBytes.size();
-
-	buffer1[ZIP_LH_OFF_NAMELEN] = sz & 0xFF;
-	buffer1[ZIP_LH_OFF_NAMELEN + 1] = (sz >> 8) & 0xFF;
-
-	// extra field length
-	buffer1[ZIP_LH_OFF_XLEN] = buffer1[ZIP_LH_OFF_XLEN + 1] = 0;
-
-	// Store offset to write crc and compressed size
-	h->lhOffset = device->pos();
-	quint32 crcOffset = h->lhOffset + ZIP_LH_OFF_CRC;
-
-	if (device->write(buffer1, ZIP_LOCAL_HEADER_SIZE) != ZIP_LOCAL_HEADER_SIZE) {
-		delete h;
-		lastError = WriteFailed;
-            return false;
-	      }
-
-	// Write out filename
-	if (device->write(entryNameBytes) != sz) {
-		delete h;
-		lastError = WriteFailed;
-            return false;
-	      }
+	ZipEntryP* h = writeLocalHeader(entryName, dt, level, 0, 0, dirOnly ? 0 : actualFile.size());
+	if (h == 0)
+		return false;
 
 	qint64 written = 0;
 	quint32 crc = crc32(0L, Z_NULL, 0);
@@ -339,12 +265,13 @@ bool Zip::createEntry(const QString& entryName,
 			while ( (read = actualFile.read(buffer1, BUFFER_SIZE)) > 0 ) {
 				crc = crc32(crc, uBuffer, read);
 
-				if ( (written = device->write(buffer1, read)) != read ) {
+				if (device->write(buffer1, read) != read) {
 					actualFile.close();
 					delete h;
 					lastError = WriteFailed;
                               return false;
 				      }
+				written += read;
 			      }
 		      }
 		else {
@@ -436,31 +363,11 @@ bool Zip::createEntry(const QString& entryName,
 		actualFile.close();
 	}
 
-	// Store end of entry offset
-	quint32 current = device->pos();
-
-	// Update crc and compressed size in local header
-	if (!device->seek(crcOffset)) {
-		delete h;
-		lastError = SeekFailed;
-            return false;
-	      }
-
 	h->crc = dirOnly ? 0 : crc;
 	h->szComp += written;
 
-	setULong(h->crc, buffer1, 0);
-	setULong(h->szComp, buffer1, 4);
-	if ( device->write(buffer1, 8) != 8) {
-		delete h;
-		lastError = WriteFailed;
-            return false;
-	      }
-
-	// Seek to end of entry
-	if (!device->seek(current)) {
+	if (!updateLocalHeader(h)) {
 		delete h;
-		lastError = SeekFailed;
             return false;
 	      }
 
@@ -505,8 +412,345 @@ void Zip::setULong(quint32 v, char* buffer, unsigned int offset)
 	buffer[offset] = (v & 0xFF);
       }
 
+//---------------------------------------------------------
+//   writeLocalHeader
+//    write the local file header for a new entry at the
+//    current device position; \p crc and the sizes may be
+//    zero and patched later by updateLocalHeader()
+//---------------------------------------------------------
+
+ZipEntryP* Zip::writeLocalHeader(const QString& entryName, QDateTime dt, int level,
+   quint32 crc, quint32 szComp, quint32 szUncomp)
+      {
+      ZipEntryP* h = new ZipEntryP;
+
+      h->compMethod = (level == 0) ? 0 : 0x0008;
+
+      QDate d = dt.date();
+      h->modDate[1] = ((d.year() - 1980) << 1) & 254;
+      h->modDate[1] |= ((d.month() >> 3) & 1);
+      h->modDate[0] = ((d.month() & 7) << 5) & 224;
+      h->modDate[0] |= d.day();
+
+      QTime t = dt.time();
+      h->modTime[1] = (t.hour() << 3) & 248;
+      h->modTime[1] |= ((t.minute() >> 3) & 7);
+      h->modTime[0] = ((t.minute() & 7) << 5) & 224;
+      h->modTime[0] |= t.second() / 2;
+
+      h->crc      = crc;
+      h->szComp   = szComp;
+      h->szUncomp = szUncomp;
+
+      // signature
+      buffer1[0] = 'P'; buffer1[1] = 'K';
+      buffer1[2] = 0x3; buffer1[3] = 0x4;
+
+      // version needed to extract
+      buffer1[ZIP_LH_OFF_VERS] = ZIP_VERSION;
+      buffer1[ZIP_LH_OFF_VERS + 1] = 0;
+
+      // general purpose flag
+      buffer1[ZIP_LH_OFF_GPFLAG] = h->gpFlag[0];
+      buffer1[ZIP_LH_OFF_GPFLAG + 1] = h->gpFlag[1];
+
+      // compression method
+      buffer1[ZIP_LH_OFF_CMET] = h->compMethod & 0xFF;
+      buffer1[ZIP_LH_OFF_CMET + 1] = (h->compMethod>>8) & 0xFF;
+
+      // last mod file time
+      buffer1[ZIP_LH_OFF_MODT] = h->modTime[0];
+      buffer1[ZIP_LH_OFF_MODT + 1] = h->modTime[1];
+
+      // last mod file date
+      buffer1[ZIP_LH_OFF_MODD] = h->modDate[0];
+      buffer1[ZIP_LH_OFF_MODD + 1] = h->modDate[1];
+
+      setULong(h->crc, buffer1, ZIP_LH_OFF_CRC);
+      setULong(h->szComp, buffer1, ZIP_LH_OFF_CSIZE);
+      setULong(h->szUncomp, buffer1, ZIP_LH_OFF_USIZE);
+
+      // filename length
+      QByteArray entryNameBytes = entryName.toUtf8();
+      int sz = entryNameBytes.size();
+
+      buffer1[ZIP_LH_OFF_NAMELEN] = sz & 0xFF;
+      buffer1[ZIP_LH_OFF_NAMELEN + 1] = (sz >> 8) & 0xFF;
+
+      // extra field length
+      buffer1[ZIP_LH_OFF_XLEN] = buffer1[ZIP_LH_OFF_XLEN + 1] = 0;
+
+      h->lhOffset = device->pos();
+
+      if (device->write(buffer1, ZIP_LOCAL_HEADER_SIZE) != ZIP_LOCAL_HEADER_SIZE
+         || device->write(entryNameBytes) != sz) {
+            delete h;
+            lastError = WriteFailed;
+            return 0;
+            }
+      return h;
+      }
+
+//---------------------------------------------------------
+//   updateLocalHeader
+//    patch crc and sizes of the local header of \p h and
+//    return to the current device position
+//---------------------------------------------------------
+
+bool Zip::updateLocalHeader(ZipEntryP* h)
+      {
+      qint64 current = device->pos();
+
+      if (!device->seek(h->lhOffset + ZIP_LH_OFF_CRC)) {
+            lastError = SeekFailed;
+            return false;
+            }
+      char buffer[12];
+      setULong(h->crc, buffer, 0);
+      setULong(h->szComp, buffer, 4);
+      setULong(h->szUncomp, buffer, 8);
+      if (device->write(buffer, 12) != 12) {
+            lastError = WriteFailed;
+            return false;
+            }
+      if (!device->seek(current)) {
+            lastError = SeekFailed;
+            return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   compress
+//    deflate entry.data into entry.compressed; touches no
+//    Zip state and can run on any thread
+//---------------------------------------------------------
+
+void Zip::compress(ZipData& entry)
+      {
+      entry.crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef*)entry.data.constData(), entry.data.size());
+      entry.ok  = true;
+      if (entry.level == 0)
+            return;
+
+      z_stream zs;
+      zs.zalloc = Z_NULL;
+      zs.zfree  = Z_NULL;
+      zs.opaque = Z_NULL;
+      if (deflateInit2_(&zs, entry.level, Z_DEFLATED, -MAX_WBITS, 8,
+         entry.isPNGFile ? Z_RLE : Z_DEFAULT_STRATEGY, ZLIB_VERSION, sizeof(z_stream)) != Z_OK) {
+            entry.ok = false;
+            return;
+            }
+      entry.compressed.resize(deflateBound(&zs, entry.data.size()));
+      zs.next_in   = (Bytef*) entry.data.constData();
+      zs.avail_in  = entry.data.size();
+      zs.next_out  = (Bytef*) entry.compressed.data();
+      zs.avail_out = entry.compressed.size();
+      if (deflate(&zs, Z_FINISH) != Z_STREAM_END)
+            entry.ok = false;
+      entry.compressed.resize(zs.total_out);
+      deflateEnd(&zs);
+      }
+
+//---------------------------------------------------------
+//   createEntry
+//    write an in memory entry; compresses it first if
+//    this was not already done by compress()
+//---------------------------------------------------------
+
+bool Zip::createEntry(const ZipData& entry, QDateTime dt)
+      {
+      if (device == 0) {
+            lastError = NoOpenArchive;
+            return false;
+            }
+      if (!entry.ok) {
+            ZipData e(entry);
+            compress(e);
+            if (!e.ok) {
+                  lastError = ZlibError;
+                  return false;
+                  }
+            return createEntry(e, dt);
+            }
+      const QByteArray& ba = entry.level == 0 ? entry.data : entry.compressed;
+      ZipEntryP* h = writeLocalHeader(entry.name, dt, entry.level, entry.crc,
+         ba.size(), entry.data.size());
+      if (h == 0)
+            return false;
+      if (device->write(ba) != ba.size()) {
+            delete h;
+            lastError = WriteFailed;
+            return false;
+            }
+      headers->insert(entry.name, h);
+      return true;
+      }
+
+//---------------------------------------------------------
+//   createEntries
+//    compress all entries in parallel, then write them
+//    in list order
+//---------------------------------------------------------
+
+bool Zip::createEntries(QList<ZipData>& entries, QDateTime dt)
+      {
+      QtConcurrent::blockingMap(entries, compress);
+      foreach(const ZipData& entry, entries) {
+            if (!entry.ok) {
+                  lastError = ZlibError;
+                  return false;
+                  }
+            if (!createEntry(entry, dt))
+                  return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   beginEntry
+//    start a streamed entry; data is passed in with
+//    writeEntry() (or through a ZipEntryDevice) and
+//    deflated straight to the archive device
+//---------------------------------------------------------
+
+bool Zip::beginEntry(const QString& entryName, QDateTime dt, int level)
+      {
+      if (device == 0) {
+            lastError = NoOpenArchive;
+            return false;
+            }
+      if (curEntry)
+            endEntry();
+      curEntry = writeLocalHeader(entryName, dt, level, 0, 0, 0);
+      if (curEntry == 0)
+            return false;
+      curName       = entryName;
+      curEntry->crc = crc32(0L, Z_NULL, 0);
+      entryFailed   = false;
+      if (level == 0)
+            return true;
+
+      zstr = new z_stream;
+      zstr->zalloc = Z_NULL;
+      zstr->zfree  = Z_NULL;
+      zstr->opaque = Z_NULL;
+      if (deflateInit2_(zstr, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY,
+         ZLIB_VERSION, sizeof(z_stream)) != Z_OK) {
+            delete zstr;
+            zstr = 0;
+            delete curEntry;
+            curEntry  = 0;
+            lastError = ZlibError;
+            return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   writeEntry
+//---------------------------------------------------------
+
+bool Zip::writeEntry(const char* data, qint64 len)
+      {
+      if (curEntry == 0) {
+            lastError = NoOpenArchive;
+            return false;
+            }
+      if (entryFailed)
+            return false;
+      curEntry->crc       = crc32(curEntry->crc, (const Bytef*)data, len);
+      curEntry->szUncomp += len;
+
+      if (zstr == 0) {
+            if (device->write(data, len) != len) {
+                  lastError   = WriteFailed;
+                  entryFailed = true;
+                  return false;
+                  }
+            curEntry->szComp += len;
+            return true;
+            }
+      zstr->next_in  = (Bytef*) data;
+      zstr->avail_in = len;
+      do {
+            zstr->next_out  = (Bytef*) buffer2;
+            zstr->avail_out = BUFFER_SIZE;
+            deflate(zstr, Z_NO_FLUSH);
+            qint64 n = BUFFER_SIZE - zstr->avail_out;
+            if (n && device->write(buffer2, n) != n) {
+                  lastError   = WriteFailed;
+                  entryFailed = true;
+                  return false;
+                  }
+            curEntry->szComp += n;
+            } while (zstr->avail_out == 0);
+      return true;
+      }
+
+//---------------------------------------------------------
+//   endEntry
+//    flush the deflate stream and patch the local header;
+//    fails if any write to the entry failed
+//---------------------------------------------------------
+
+bool Zip::endEntry()
+      {
+      if (curEntry == 0) {
+            lastError = NoOpenArchive;
+            return false;
+            }
+      bool rv = !entryFailed;
+      if (zstr && rv) {
+            zstr->next_in  = 0;
+            zstr->avail_in = 0;
+            int zret;
+            do {
+                  zstr->next_out  = (Bytef*) buffer2;
+                  zstr->avail_out = BUFFER_SIZE;
+                  zret = deflate(zstr, Z_FINISH);
+                  qint64 n = BUFFER_SIZE - zstr->avail_out;
+                  if (n && device->write(buffer2, n) != n) {
+                        lastError = WriteFailed;
+                        rv = false;
+                        break;
+                        }
+                  curEntry->szComp += n;
+                  } while (zret == Z_OK);
+            }
+      if (zstr) {
+            deflateEnd(zstr);
+            delete zstr;
+            zstr = 0;
+            }
+      if (rv)
+            rv = updateLocalHeader(curEntry);
+      if (rv)
+            headers->insert(curName, curEntry);
+      else {
+            lastError   = WriteFailed;
+            writeFailed = true;
+            delete curEntry;
+            }
+      curEntry    = 0;
+      entryFailed = false;
+      return rv;
+      }
+
+//---------------------------------------------------------
+//   writeData
+//---------------------------------------------------------
+
+qint64 ZipEntryDevice::writeData(const char* data, qint64 len)
+      {
+      return zip->writeEntry(data, len) ? len : -1;
+      }
+
 //---------------------------------------------------------
 //   closeArchive
+//    fails if any entry of the archive could not be
+//    written completely
 //---------------------------------------------------------
 
 bool Zip::closeArchive()
@@ -516,6 +760,13 @@ bool Zip::closeArchive()
 
 	if (device == 0 || headers == 0)
 		return true;
+      if (curEntry)
+            endEntry();
+      if (writeFailed) {
+            lastError = WriteFailed;
+            reset();
+            return false;
+            }
 
 	const ZipEntryP* h;
 
@@ -598,6 +849,7 @@ bool Zip::closeArchive()
 				qDebug() << tr("Unable to delete corrupted archive: %1").arg(device->fileName());
 			*/
 			lastError = WriteFailed;
+                  reset();
                   return false;
 		      }
 
@@ -609,6 +861,7 @@ bool Zip::closeArchive()
 				qDebug() << tr("Unable to delete corrupted archive: %1").arg(device->fileName());
 				*/
 			lastError = WriteFailed;
+                  reset();
                   return false;
 		      }
 
@@ -653,9 +906,17 @@ bool Zip::closeArchive()
 			qDebug() << tr("Unable to delete corrupted archive: %1").arg(device->fileName());
 			*/
 		lastError = WriteFailed;
+            reset();
             return false;
 	      }
 
+      // QFile buffers; make sure the data really went out
+      QFile* file = qobject_cast<QFile*>(device);
+      if (file && !file->flush()) {
+            lastError = WriteFailed;
+            reset();
+            return false;
+            }
       reset();
 	return true;
       }
@@ -864,6 +1125,80 @@ bool Unzip::extractFile(const QString& filename, QIODevice* dev)
       return false;
       }
 
+//---------------------------------------------------------
+//   fileData
+//    Return the uncompressed content of \p filename. The
+//    compressed entry is read in one go and inflated
+//    straight into the result, which is sized from the
+//    central directory; returns an empty array on error.
+//---------------------------------------------------------
+
+QByteArray Unzip::fileData(const QString& filename)
+      {
+      QMap<QString,ZipEntryP*>::Iterator itr = headers->find(filename);
+      if (itr == headers->end()) {
+            lastError = FileNotFound;
+            return QByteArray();
+            }
+      ZipEntryP& entry = *itr.value();
+      if (!entry.lhEntryChecked) {
+            lastError = parseLocalHeaderRecord(filename, entry);
+            entry.lhEntryChecked = true;
+            if (lastError != Ok)
+                  return QByteArray();
+            }
+      if (entry.compMethod != 0 && entry.compMethod != 8) {
+            lastError = Corrupted;
+            return QByteArray();
+            }
+      if (!device->seek(entry.dataOffset)) {
+            lastError = SeekFailed;
+            return QByteArray();
+            }
+      QByteArray src = device->read(entry.szComp);
+      if (src.size() != int(entry.szComp)) {
+            lastError = ReadFailed;
+            return QByteArray();
+            }
+      QByteArray dst;
+      if (entry.compMethod == 0)
+            dst = src;
+      else {
+            // deflate cannot compress better than about 1:1032; a larger
+            // size in the directory is corrupt and must not be allocated
+            if (entry.szUncomp > quint32(INT_MAX)
+               || quint64(entry.szUncomp) > quint64(entry.szComp) * 1032 + 1024) {
+                  lastError = Corrupted;
+                  return QByteArray();
+                  }
+            dst.resize(entry.szUncomp);
+            z_stream zs;
+            zs.zalloc    = Z_NULL;
+            zs.zfree     = Z_NULL;
+            zs.opaque    = Z_NULL;
+            zs.next_in   = (Bytef*) src.data();
+            zs.avail_in  = src.size();
+            if (inflateInit2_(&zs, -MAX_WBITS, ZLIB_VERSION, sizeof(z_stream)) != Z_OK) {
+                  lastError = ZlibError;
+                  return QByteArray();
+                  }
+            zs.next_out  = (Bytef*) dst.data();
+            zs.avail_out = dst.size();
+            int zret     = inflate(&zs, Z_FINISH);
+            inflateEnd(&zs);
+            if (zret != Z_STREAM_END || zs.total_out != entry.szUncomp) {
+                  lastError = Corrupted;
+                  return QByteArray();
+                  }
+            }
+      if (crc32(crc32(0L, Z_NULL, 0), (const Bytef*)dst.constData(), dst.size()) != entry.crc) {
+            lastError = Corrupted;
+            return QByteArray();
+            }
+      lastError = Ok;
+      return dst;
+      }
+
 //---------------------------------------------------------
 //   ZipEntry
 //---------------------------------------------------------
@@ -30,6 +30,29 @@ class QString;
 #define BUFFER_SIZE (256*1024)
 
 class ZipEntryP;
+class Zip;
+struct z_stream_s;
+
+//---------------------------------------------------------
+//   ZipData
+//    an archive entry held in memory; compressed
+//    concurrently by Zip::createEntries()
+//---------------------------------------------------------
+
+struct ZipData {
+      QString name;
+      QByteArray data;              ///< uncompressed entry data
+      bool isPNGFile;
+      int level;
+
+      QByteArray compressed;        ///< set by Zip::compress()
+      quint32 crc;
+      bool ok;
+
+      ZipData() : isPNGFile(false), level(9), crc(0), ok(false) {}
+      ZipData(const QString& n, const QByteArray& d, bool png = false, int l = 9)
+         : name(n), data(d), isPNGFile(png), level(l), crc(0), ok(false) {}
+      };
 
 //---------------------------------------------------------
 //   ZArchive
@@ -79,9 +102,19 @@ class Zip : public ZArchive
 	uchar* uBuffer;
 	const quint32* crcTable;
 
+      // state of the entry opened by beginEntry()
+      QString curName;
+      ZipEntryP* curEntry;
+      z_stream_s* zstr;
+      bool entryFailed;             ///< a write to the current entry failed
+      bool writeFailed;             ///< an entry of the archive could not be written
+
 	void reset();
 	bool zLibInit();
 	void setULong(quint32 v, char* buffer, uint offset);
+      ZipEntryP* writeLocalHeader(const QString& entryName, QDateTime dt, int level,
+         quint32 crc, quint32 szComp, quint32 szUncomp);
+      bool updateLocalHeader(ZipEntryP* h);
 
    public:
 	Zip();
@@ -90,9 +123,36 @@ class Zip : public ZArchive
 	bool createArchive(const QString& file);
 	bool createArchive(QIODevice* device);
 	bool createEntry(const QString& entryName, QIODevice& actualFile, QDateTime dt, bool dirOnly = false, bool isPNGFile = false, int level = 9);
+      bool createEntry(const ZipData& entry, QDateTime dt);
+      bool createEntries(QList<ZipData>& entries, QDateTime dt);
+      static void compress(ZipData& entry);
+
+      bool beginEntry(const QString& entryName, QDateTime dt, int level = 9);
+      bool writeEntry(const char* data, qint64 len);
+      bool endEntry();
+
 	bool closeArchive();
       };
 
+//---------------------------------------------------------
+//   ZipEntryDevice
+//    write only device which deflates everything written
+//    to it into the entry opened with Zip::beginEntry()
+//---------------------------------------------------------
+
+class ZipEntryDevice : public QIODevice
+      {
+      Zip* zip;
+
+   protected:
+      virtual qint64 readData(char*, qint64) { return -1; }
+      virtual qint64 writeData(const char* data, qint64 len);
+
+   public:
+      ZipEntryDevice(Zip* z) : zip(z) {}
+      virtual bool isSequential() const { return true; }
+      };
+
 //---------------------------------------------------------
 //   Unzip
 //---------------------------------------------------------
@@ -165,6 +225,7 @@ class Unzip : public ZArchive
 	void closeArchive();
 	bool contains(const QString& file) const;
 	bool extractFile(const QString& filename, QIODevice* device);
+      QByteArray fileData(const QString& filename);
       };
 
 #endif